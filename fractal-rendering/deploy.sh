@@ -4,6 +4,8 @@
 set -e
 
 # build cpp
+# GitHub Pages cannot send the COOP and COEP headers that wasm threads need, so this keeps the single threaded
+# default; pass -DFLOW_THREADS=ON to emcmake only for hosts that serve the page cross-origin isolated
 cd src/cpp
 rm -rf build
 mkdir build
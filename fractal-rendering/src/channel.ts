@@ -0,0 +1,251 @@
+// Binary channel to the renderer: commands go into a ring buffer in wasm memory and stats are read from a
+// telemetry block next to it. The layouts mirror src/cpp/src/messaging/CommandQueue.hpp and Telemetry.hpp.
+import type { Profile, ProfileSummary } from "@/store/app";
+
+export enum CommandType {
+  threads = 1,
+  paused,
+  setC,
+  animateC,
+  view,
+  resetView,
+  quality,
+  paletteStop,
+  paletteCommit,
+  paletteDefault,
+  formula,
+  frameCache,
+  pipelined,
+  seek,
+  playbackRate,
+  loopRange,
+  record,
+}
+
+// Mirrors FractalRenderer::Formula
+export enum Formula {
+  julia,
+  juliaCubic,
+  mandelbrot,
+  mandelbrotCubic,
+  burningShip,
+}
+
+export interface FlowModule {
+  HEAPU8: Uint8Array;
+  UTF8ToString(pointer: number): string;
+  _flow_command_queue(): number;
+  _flow_telemetry(): number;
+  _flow_stage_name(stage: number): number;
+  _flow_counter_name(counter: number): number;
+  _flow_trace_recording(): number;
+  _flow_trace(): number;
+  _flow_trace_size(): number;
+}
+
+export interface Telemetry {
+  // drawn frames and render loop wakeups per second, and the share of the time the loop was busy
+  frameRate: number;
+  wakeupRate: number;
+  cpuLoad: number;
+  threads: number;
+  resolution: number;
+  maxIterations: number;
+  // share of frames replayed from the frame cache, and its size in bytes
+  cacheHitRate: number;
+  cacheBytes: number;
+  // position of the c animation in its loop, in [0, 1)
+  progress: number;
+  // null when no frame was profiled since the previous update
+  profile: Profile | null;
+}
+
+const queueHead = 0;
+const queueTail = 64;
+const queueCommands = 128;
+const queueCapacity = 256;
+const commandSize = 56;
+const commandArgs = 8;
+const commandArgCount = 6;
+
+const telemetryValues = 16;
+const telemetryFields = 10;
+
+let module: FlowModule | null = null;
+let queue = 0;
+let telemetry = 0;
+let stageNames: string[] = [];
+let counterNames: string[] = [];
+let lastSequence = 0;
+
+export function attach(flowModule: FlowModule) {
+  module = flowModule;
+  queue = module._flow_command_queue();
+  telemetry = module._flow_telemetry();
+
+  const header = new Uint32Array(module.HEAPU8.buffer, telemetry, 4);
+  stageNames = Array.from({ length: header[1] }, (_, i) =>
+    flowModule.UTF8ToString(flowModule._flow_stage_name(i))
+  );
+  counterNames = Array.from({ length: header[2] }, (_, i) =>
+    flowModule.UTF8ToString(flowModule._flow_counter_name(i))
+  );
+}
+
+// Returns false when the renderer is not attached yet or has not caught up with the queue
+export function sendCommand(type: CommandType, ...args: number[]): boolean {
+  if (!module) return false;
+
+  // views are created per call since memory growth replaces the buffer
+  const buffer = module.HEAPU8.buffer;
+  const indices = new Int32Array(buffer, queue, queueCommands / 4);
+  const head = Atomics.load(indices, queueHead / 4) >>> 0;
+  const tail = Atomics.load(indices, queueTail / 4) >>> 0;
+  if (((head - tail) >>> 0) === queueCapacity) return false;
+
+  const command = new DataView(buffer, queue + queueCommands + (head % queueCapacity) * commandSize, commandSize);
+  command.setUint32(0, type, true);
+  command.setUint32(4, 0, true);
+  for (let i = 0; i < commandArgCount; i++) command.setFloat64(commandArgs + i * 8, args[i] ?? 0, true);
+
+  // publishes the command to the render loop
+  Atomics.store(indices, queueHead / 4, (head + 1) | 0);
+  return true;
+}
+
+export function setC(real: number, imag: number) {
+  return sendCommand(CommandType.setC, real, imag);
+}
+
+// Splits the center coordinates into double-double pairs; plain numbers have a zero low part
+export function setView(x: number, y: number, halfHeight: number, xLow = 0, yLow = 0) {
+  return sendCommand(CommandType.view, x, xLow, y, yLow, halfHeight);
+}
+
+// Omitted settings are kept
+export function setQuality(quality: {
+  adaptive?: boolean;
+  targetFrameTime?: number;
+  resolution?: [number, number];
+  maxIterations?: [number, number];
+}) {
+  return sendCommand(
+    CommandType.quality,
+    quality.adaptive === undefined ? -1 : Number(quality.adaptive),
+    quality.targetFrameTime ?? -1,
+    quality.resolution?.[0] ?? -1,
+    quality.resolution?.[1] ?? -1,
+    quality.maxIterations?.[0] ?? -1,
+    quality.maxIterations?.[1] ?? -1
+  );
+}
+
+export function setPalette(stops: { position: number; color: [number, number, number] }[]) {
+  for (const stop of stops) {
+    if (!sendCommand(CommandType.paletteStop, stop.position, ...stop.color)) return false;
+  }
+  return sendCommand(CommandType.paletteCommit);
+}
+
+export function setFormula(formula: Formula) {
+  return sendCommand(CommandType.formula, formula);
+}
+
+// Replays the frames of the c animation loop from memory once they were rendered; the budget is in MiB and is kept
+// when omitted
+export function setFrameCache(enabled: boolean, budget = -1) {
+  return sendCommand(CommandType.frameCache, Number(enabled), budget);
+}
+
+// Renders the next frame while the current one is presented, at the cost of one frame of latency
+export function setPipelined(enabled: boolean) {
+  return sendCommand(CommandType.pipelined, Number(enabled));
+}
+
+// Timeline of the c animation; the renderer only draws frames while c or a setting changes
+export function setPaused(paused: boolean) {
+  return sendCommand(CommandType.paused, Number(paused));
+}
+
+// Also returns c to the animation after setC
+export function seek(progress: number) {
+  return sendCommand(CommandType.seek, progress);
+}
+
+// 1 is the default speed, a negative rate plays backwards
+export function setPlaybackRate(rate: number) {
+  return sendCommand(CommandType.playbackRate, rate);
+}
+
+// Loops the animation between two positions in [0, 1]; an empty range is the whole loop
+export function setLoopRange(start: number, end: number) {
+  return sendCommand(CommandType.loopRange, start, end);
+}
+
+// Records every input of the renderer from here on into a trace for fractal_replay, replacing the previous one
+export function startRecording() {
+  return sendCommand(CommandType.record, 1);
+}
+
+// Resolves with the trace once the render loop has stopped recording, or null when it could not be told to
+export async function stopRecording(): Promise<Uint8Array | null> {
+  if (!module || !sendCommand(CommandType.record, 0)) return null;
+
+  const flowModule = module;
+  while (flowModule._flow_trace_recording()) await new Promise((resolve) => setTimeout(resolve, 50));
+  return flowModule.HEAPU8.slice(flowModule._flow_trace(), flowModule._flow_trace() + flowModule._flow_trace_size());
+}
+
+// Returns the telemetry written since the previous call, or null when there is none
+export function readTelemetry(): Telemetry | null {
+  if (!module) return null;
+
+  const buffer = module.HEAPU8.buffer;
+  const sequence = new Int32Array(buffer, telemetry, 1);
+  const length = telemetryFields + 3 * (stageNames.length + counterNames.length);
+
+  // retried while the render loop is in the middle of a write
+  for (let attempt = 0; attempt < 4; attempt++) {
+    const before = Atomics.load(sequence, 0);
+    if (before === lastSequence) return null;
+    if (before & 1) continue;
+
+    const values = new Float64Array(buffer, telemetry + telemetryValues, length).slice();
+    if (Atomics.load(sequence, 0) !== before) continue;
+
+    lastSequence = before;
+    return parseTelemetry(values);
+  }
+  return null;
+}
+
+function parseTelemetry(values: Float64Array): Telemetry {
+  const summaries = (names: string[], offset: number) => {
+    const result: Record<string, ProfileSummary> = {};
+    names.forEach((name, i) => {
+      const at = offset + i * 3;
+      result[name] = { min: values[at], mean: values[at + 1], p95: values[at + 2] };
+    });
+    return result;
+  };
+
+  const profileFrames = values[6];
+  return {
+    frameRate: values[0],
+    wakeupRate: values[1],
+    cpuLoad: values[2],
+    threads: values[3],
+    resolution: values[4],
+    maxIterations: values[5],
+    cacheHitRate: values[7],
+    cacheBytes: values[8],
+    progress: values[9],
+    profile: profileFrames
+      ? {
+          frames: profileFrames,
+          stages: summaries(stageNames, telemetryFields),
+          counters: summaries(counterNames, telemetryFields + 3 * stageNames.length),
+        }
+      : null,
+  };
+}
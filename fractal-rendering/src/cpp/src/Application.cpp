@@ -13,7 +13,7 @@ Application::Application() {
     return;
   }
 
-  sketch_ = std::make_unique<Sketch>(renderer_);
+  session_ = std::make_unique<Session>(renderer_);
 
   last_time_ = SDL_GetTicks64();
 }
@@ -21,15 +21,32 @@ Application::Application() {
 Application::~Application() { SDL_DestroyWindow(window_); }
 
 void Application::loop() {
+  const auto wakeup_start = std::chrono::steady_clock::now();
+  wakeups_++;
+
   handle_window_events_();
-  handle_messages_();
+  {
+    Profiler::Scope scope(&session_->get_profiler(), Profiler::messages);
+    handle_commands_();
+  }
 
   sync_data_();
 
-  double delta_time = get_delta_time_();
+  if (session_->tick(get_delta_time_())) drawn_frames_++;
+  set_idle_(session_->is_idle());
+
+  const std::chrono::duration<double, std::milli> busy_time =
+      std::chrono::steady_clock::now() - wakeup_start;
+  busy_ms_ += busy_time.count();
+}
 
-  sketch_->update(delta_time);
-  sketch_->draw();
+void Application::set_idle_(const bool& idle) {
+  if (idle == idle_) return;
+  idle_ = idle;
+  if (idle)
+    emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, idle_poll_period_);
+  else
+    emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
 }
 
 void Application::handle_window_events_() {
@@ -41,65 +58,102 @@ void Application::handle_window_events_() {
       case SDL_WINDOWEVENT:
         switch (window_event_.window.event) {
           case SDL_WINDOWEVENT_RESIZED:
-            sketch_->set_window_size(window_event_.window.data1,
-                                     window_event_.window.data2);
+            session_->resize(window_event_.window.data1,
+                             window_event_.window.data2);
             break;
         }
         break;
+      case SDL_MOUSEWHEEL: {
+        int mouse_x, mouse_y;
+        SDL_GetMouseState(&mouse_x, &mouse_y);
+        session_->zoom_at(mouse_x, mouse_y, window_event_.wheel.y);
+        break;
+      }
+      case SDL_MOUSEMOTION:
+        if (window_event_.motion.state & SDL_BUTTON_LMASK)
+          session_->pan(window_event_.motion.xrel, window_event_.motion.yrel);
+        break;
     }
   }
 }
 
-void Application::handle_messages_() {
-  if (Messenger::instance().has_message()) {
-    std::string message = Messenger::instance().get_message();
-    std::cout << "Message: " << message << "\n";
+// Applies every command the page queued since the last frame; recording is
+// up to the app, everything else goes to the session
+void Application::handle_commands_() {
+  Command command;
+  while (Messenger::instance().commands().pop(command)) {
+    if (command.type == Command::record)
+      set_recording_(command.args[0] != 0.0);
+    else
+      session_->apply_command(command);
   }
 }
 
+// A new recording replaces the previous trace, which the page reads once this
+// one stopped
+void Application::set_recording_(const bool& recording) {
+  Messenger& messenger = Messenger::instance();
+  if (recording == messenger.is_recording()) return;
+
+  if (recording) messenger.trace().clear();
+  session_->set_trace(recording ? &messenger.trace() : nullptr);
+  messenger.set_recording(recording);
+}
+
 double Application::get_delta_time_() {
   Uint64 current_time = SDL_GetTicks64();
   Uint64 delta_time = current_time - last_time_;
   last_time_ = current_time;
-  delta_time_records_.push_back(delta_time);
-  if (delta_time_records_.size() > max_delta_time_records_)
-    delta_time_records_.pop_front();
   return (double)delta_time;
 }
 
 void Application::sync_data_() {
   Uint64 current_time = SDL_GetTicks64();
-  if (current_time - last_data_sync_time_ < data_sync_period_) return;
+  const Uint64 elapsed = current_time - last_data_sync_time_;
+  if (elapsed < data_sync_period_) return;
   last_data_sync_time_ = current_time;
 
-  send_frame_rate_();
-}
-
-void Application::send_frame_rate_() {
-  rapidjson::Document message_doc;
-  message_doc.SetObject();
-  rapidjson::Document::AllocatorType& allocator = message_doc.GetAllocator();
-  {
-    message_doc.AddMember("to", "js", allocator);
-    rapidjson::Value message_obj;
-    message_obj.SetObject();
-    { message_obj.AddMember("frame_rate", get_frame_rate(), allocator); }
-    message_doc.AddMember("message", message_obj, allocator);
-  }
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-  message_doc.Accept(writer);
-  std::string json_string = buffer.GetString();
-
-  Messenger::instance().send_message(json_string);
+  publish_telemetry_(elapsed);
 }
 
-Uint64 Application::get_frame_rate() const noexcept {
-  if (!delta_time_records_.size()) return 0;
-
-  Uint64 sum = 0;
-  for (Uint64 delta_time : delta_time_records_) sum += delta_time;
-  Uint64 average_delta_time = sum / delta_time_records_.size();
-  if (!average_delta_time) return 0;
-  return 1000 / average_delta_time;
+// Writes the rates of drawn frames and loop wakeups and the share of the
+// elapsed ms since the last sync the loop was busy, the current quality and
+// timeline progress, the frame cache stats and min/mean/p95 of every stage (in
+// ms) and counter over the frames drawn since then
+void Application::publish_telemetry_(const Uint64& elapsed) {
+  const Sketch& sketch = session_->get_sketch();
+  Profiler& profiler = session_->get_profiler();
+  const QualityController::Quality& quality = session_->get_quality();
+  const std::size_t profile_frames = profiler.get_frame_count();
+
+  Messenger::instance().telemetry().write([&](Telemetry& telemetry) {
+    telemetry.frame_rate = drawn_frames_ * 1000.0 / elapsed;
+    telemetry.wakeup_rate = wakeups_ * 1000.0 / elapsed;
+    telemetry.cpu_load = busy_ms_ / elapsed;
+    telemetry.progress = sketch.get_progress();
+    telemetry.threads = static_cast<double>(sketch.get_thread_count());
+    telemetry.resolution = quality.resolution;
+    telemetry.max_iterations = quality.max_iterations;
+    telemetry.profile_frames = static_cast<double>(profile_frames);
+    telemetry.cache_bytes =
+        static_cast<double>(sketch.get_frame_cache().get_size());
+    telemetry.cache_hit_rate =
+        profile_frames ? profiler.summarize(Profiler::cache_hits).mean : 0.0;
+    if (!profile_frames) return;
+
+    const auto copy = [](const Profiler::Summary& from,
+                         Telemetry::Summary& to) {
+      to = {from.min, from.mean, from.p95};
+    };
+    for (int stage = 0; stage < Profiler::stage_count; stage++)
+      copy(profiler.summarize(static_cast<Profiler::Stage>(stage)),
+           telemetry.stages[stage]);
+    for (int counter = 0; counter < Profiler::counter_count; counter++)
+      copy(profiler.summarize(static_cast<Profiler::Counter>(counter)),
+           telemetry.counters[counter]);
+  });
+  profiler.clear();
+  wakeups_ = 0;
+  drawn_frames_ = 0;
+  busy_ms_ = 0.0;
 }
@@ -1,9 +1,15 @@
 #include <SDL2/SDL.h>
 
-#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <vector>
 
-#include "Sketch/Sketch.hpp"
+#include "Profiler/Profiler.hpp"
+#include "QualityController/QualityController.hpp"
+#include "Session/Session.hpp"
 #include "messaging/messaging.hpp"
 
 class Application {
@@ -13,27 +19,35 @@ class Application {
 
     void loop();
 
-    Uint64 get_frame_rate() const noexcept;
-
    private:
-    std::unique_ptr<Sketch> sketch_;
+    std::unique_ptr<Session> session_;
 
     SDL_Window *window_;
     SDL_Renderer *renderer_;
     SDL_Event window_event_;
 
     Uint64 last_time_ = 0;
-    std::deque<Uint64> delta_time_records_;
-    std::size_t max_delta_time_records_ = 50;
+
+    // While no frame is needed and the animation is stopped, the loop runs on a timer of idle_poll_period_ ms instead
+    // of every display refresh, only to pick up commands and events
+    bool idle_ = false;
+    int idle_poll_period_ = 100;
+
+    // loop wakeups, drawn frames and time spent in the loop since the last sync
+    Uint64 wakeups_ = 0;
+    Uint64 drawn_frames_ = 0;
+    double busy_ms_ = 0.0;
 
     Uint64 data_sync_period_ = 1000;
     Uint64 last_data_sync_time_ = 0;
 
     void handle_window_events_();
-    void handle_messages_();
+    void handle_commands_();
+    void set_recording_(const bool &recording);
+    void set_idle_(const bool &idle);
 
     double get_delta_time_();
 
     void sync_data_();
-    void send_frame_rate_();
+    void publish_telemetry_(const Uint64 &elapsed);
 };
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef BOUNDED_QUEUE_HPP
+#define BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Blocking FIFO between threads with a fixed capacity: push waits while the queue is full and pop while it is empty,
+// so a fast producer is held back to the pace of its consumer instead of buffering without limit.
+// After close(), push drops its value and pop drains what is left, then returns nothing.
+template <typename Value>
+class BoundedQueue {
+   public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    // Returns false when the queue was closed
+    bool push(Value value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [&] { return closed_ || values_.size() < capacity_; });
+        if (closed_) return false;
+
+        values_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    std::optional<Value> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [&] { return closed_ || !values_.empty(); });
+        if (values_.empty()) return std::nullopt;
+
+        Value value = std::move(values_.front());
+        values_.pop_front();
+        not_full_.notify_one();
+        return value;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+   private:
+    std::size_t capacity_;
+    std::deque<Value> values_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#include "CPath.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+CPath::CPath()
+    : CPath({
+          {0.0f, 0.0f},    {-0.4f, -0.59f},    {-0.702f, -0.384f},  {-0.835f, -0.2321f}, {-2.0f, 0.0f},
+          {-0.8f, 0.156f}, {-0.835f, 0.2321f}, {-0.7269f, 0.1889f}, {-0.54f, 0.54f},     {-0.4f, 0.6f},
+          {0.0f, 0.8f},    {0.078f, 0.656f},   {0.355f, 0.355f},    {0.45f, 0.1428f},    {0.37f, 0.1f},
+          {0.285f, 0.01},  {0.285f, 0.0f},     {0.34f, -0.05},      {0.0f, 0.0f},
+      }) {}
+
+CPath::CPath(std::vector<Point> points) : points_(std::move(points)) {}
+
+CPath::Point CPath::at(const float& progress) const noexcept {
+    const float position = progress * (points_.size() - 1);
+    const std::size_t index = std::min(static_cast<std::size_t>(position), points_.size() - 2);
+    const float fraction = position - index;
+
+    const Point& current_point = points_[index];
+    const Point& next_point = points_[index + 1];
+    return {current_point.first + (next_point.first - current_point.first) * fraction,
+            current_point.second + (next_point.second - current_point.second) * fraction};
+}
@@ -0,0 +1,27 @@
+#ifndef C_PATH_HPP
+#define C_PATH_HPP
+
+#include <utility>
+#include <vector>
+
+// Closed path of the Julia constant c through a list of points, interpolated linearly between them.
+// Shared by the live animation and the offline exporter, so both follow exactly the same c for a given progress.
+class CPath {
+   public:
+    using Point = std::pair<float, float>;
+
+    // The path the app animates
+    CPath();
+    // Needs at least two points
+    explicit CPath(std::vector<Point> points);
+
+    // c at a progress in [0, 1)
+    Point at(const float &progress) const noexcept;
+    // the points the path passes through, in order; the app's path ends where it starts
+    const std::vector<Point> &points() const noexcept { return points_; }
+
+   private:
+    std::vector<Point> points_;
+};
+
+#endif
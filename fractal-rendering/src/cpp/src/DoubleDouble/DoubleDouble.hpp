@@ -0,0 +1,69 @@
+#ifndef DOUBLE_DOUBLE_HPP
+#define DOUBLE_DOUBLE_HPP
+
+// Unevaluated sum of two doubles, giving about 32 significant decimal digits.
+// Built from error-free transformations (Knuth's two-sum and Dekker's product) so it needs no FMA,
+// which WebAssembly does not have.
+struct DoubleDouble {
+    double hi = 0.0;
+    double lo = 0.0;
+
+    constexpr DoubleDouble() = default;
+    constexpr DoubleDouble(double value) : hi(value) {}
+    constexpr DoubleDouble(double hi, double lo) : hi(hi), lo(lo) {}
+
+    explicit operator double() const noexcept { return hi + lo; }
+    explicit operator float() const noexcept { return static_cast<float>(hi + lo); }
+
+    friend DoubleDouble operator+(const DoubleDouble &a, const DoubleDouble &b) noexcept {
+        double error;
+        const double sum = two_sum_(a.hi, b.hi, error);
+        return quick_two_sum_(sum, error + a.lo + b.lo);
+    }
+
+    friend DoubleDouble operator-(const DoubleDouble &a) noexcept { return {-a.hi, -a.lo}; }
+    friend DoubleDouble operator-(const DoubleDouble &a, const DoubleDouble &b) noexcept { return a + -b; }
+
+    friend DoubleDouble operator*(const DoubleDouble &a, const DoubleDouble &b) noexcept {
+        double error;
+        const double product = two_product_(a.hi, b.hi, error);
+        return quick_two_sum_(product, error + a.hi * b.lo + a.lo * b.hi);
+    }
+
+    DoubleDouble &operator+=(const DoubleDouble &other) noexcept { return *this = *this + other; }
+    DoubleDouble &operator-=(const DoubleDouble &other) noexcept { return *this = *this - other; }
+    DoubleDouble &operator*=(const DoubleDouble &other) noexcept { return *this = *this * other; }
+
+    friend bool operator==(const DoubleDouble &a, const DoubleDouble &b) noexcept = default;
+
+   private:
+    static double two_sum_(double a, double b, double &error) noexcept {
+        const double sum = a + b;
+        const double b_virtual = sum - a;
+        error = (a - (sum - b_virtual)) + (b - b_virtual);
+        return sum;
+    }
+
+    // Requires |a| >= |b|
+    static DoubleDouble quick_two_sum_(double a, double b) noexcept {
+        const double sum = a + b;
+        return {sum, b - (sum - a)};
+    }
+
+    static void split_(double a, double &hi, double &lo) noexcept {
+        const double t = 134217729.0 * a;  // 2^27 + 1
+        hi = t - (t - a);
+        lo = a - hi;
+    }
+
+    static double two_product_(double a, double b, double &error) noexcept {
+        const double product = a * b;
+        double a_hi, a_lo, b_hi, b_lo;
+        split_(a, a_hi, a_lo);
+        split_(b, b_hi, b_lo);
+        error = ((a_hi * b_hi - product) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+        return product;
+    }
+};
+
+#endif
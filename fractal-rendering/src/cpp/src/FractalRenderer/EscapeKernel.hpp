@@ -0,0 +1,172 @@
+#ifndef ESCAPE_KERNEL_HPP
+#define ESCAPE_KERNEL_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "Formulas.hpp"
+#include "Kernels.hpp"
+
+// The escape-time kernel template behind every kernel set, written against the vector interface of Vector.hpp.
+// It is instantiated by translation units built for the vector type's instruction set, so only templates are defined
+// here: inline functions shared with other translation units could be linked in from a build the CPU cannot run.
+namespace kernels {
+
+// Approximates log2 of positive floats from their exponent and mantissa bits
+template <typename V>
+inline typename V::F fast_log2(const typename V::F &x) noexcept {
+    const typename V::F mx =
+        V::from_bits(V::or_i(V::and_i(V::bits(x), V::splat_i(0x007FFFFF)), V::splat_i(0x3f000000)));
+
+    const typename V::F y = V::mul(V::convert(V::bits(x)), V::splat(1.1920928955078125e-7f));
+    return V::sub(V::sub(V::sub(y, V::splat(124.22551499f)), V::mul(V::splat(1.498030302f), mx)),
+                  V::div(V::splat(1.72587999f), V::add(V::splat(0.3520887068f), mx)));
+}
+
+// Maps the escape iteration and final z of the lanes to smooth escape values in [0, 1]; the escape radius shrinks
+// by a power of exponent per iteration, so its double logarithm is taken to that base
+template <typename V, int exponent>
+inline typename V::F smooth_escape_value(const typename V::F &z_real, const typename V::F &z_imag,
+                                         const typename V::I &lane_iterations, int max_iterations) noexcept {
+    using F = typename V::F;
+
+    // Calculate the modulus of z
+    const F mod_squared = V::add(V::mul(z_real, z_real), V::mul(z_imag, z_imag));
+    const F mod = V::sqrt(mod_squared);
+
+    // Calculate the logarithm of the modulus
+    F log_mod = fast_log2<V>(V::max(V::splat(1.0f), fast_log2<V>(mod)));
+    if constexpr (exponent != 2)
+        log_mod = V::mul(log_mod, V::splat(static_cast<float>(1.0 / std::log2(static_cast<double>(exponent)))));
+
+    // Calculate the smooth color
+    const F smooth = V::sub(V::convert(lane_iterations), log_mod);
+    F t = V::div(smooth, V::splat(static_cast<float>(max_iterations)));
+
+    // If only one iteration was done, return 0
+    const F zero = V::splat(0.0f);
+    t = V::select(V::eq_i(lane_iterations, V::splat_i(1)), zero, t);
+
+    // If t is close to 1.0f or 0.0f, then make it exactly 1.0f or 0.0f
+    t = V::select(V::gt(t, V::splat(0.999f)), V::splat(1.0f), t);
+    return V::select(V::lt(t, V::splat(0.001f)), zero, t);
+}
+
+// Checks if the points (xs, ys) are in the set of the Policy formula, one point per lane, see Batch.
+// With per_pixel_c the points are the lanes' c and z starts at its first iterate c, otherwise they are the start z.
+// Lanes proven to be on a cycle stop early and count as never escaping.
+template <typename V, typename Policy, bool per_pixel_c>
+void escape_time(const EscapeParams &params, const float *xs, const float *ys, float *values,
+                 std::int32_t *iterations_out, std::int32_t *periodic_iterations_out) noexcept {
+    using F = typename V::F;
+    using I = typename V::I;
+    using Mask = typename V::Mask;
+
+    const F x = V::load(xs);
+    const F y = V::load(ys);
+
+    // Initialize the real and imaginary parts of the complex constant c
+    const F c_real = per_pixel_c ? x : V::splat(params.c_real);
+    const F c_imag = per_pixel_c ? y : V::splat(params.c_imag);
+
+    // Initialize constants for the number 2 and -2
+    const F two = V::splat(2.0f);
+    const F neg_two = V::splat(-2.0f);
+
+    // Initialize the real and imaginary parts of z
+    F z_real = x;
+    F z_imag = y;
+
+    // Lanes that have not escaped yet; escaped lanes keep their z and iteration count
+    Mask active = V::all();
+    I lane_iterations = V::splat_i(params.max_iterations);
+    I lane_periodic_iterations = lane_iterations;
+
+    // The main cardioid and the period-2 bulb of the Mandelbrot set are known in closed form, so their lanes are
+    // retired before the first iteration, as if proven periodic at iteration 0
+    if constexpr (per_pixel_c && std::is_same_v<Policy, PowerFormula<2>>) {
+        const F quarter = V::splat(0.25f);
+        const F y_squared = V::mul(y, y);
+        const F x_shifted = V::sub(x, quarter);
+        const F q = V::add(V::mul(x_shifted, x_shifted), y_squared);
+        const Mask in_cardioid = V::le(V::mul(q, V::add(q, x_shifted)), V::mul(y_squared, quarter));
+        const F x_bulb = V::add(x, V::splat(1.0f));
+        const Mask in_bulb = V::le(V::add(V::mul(x_bulb, x_bulb), y_squared), V::splat(0.0625f));
+        const Mask interior = V::mask_or(in_cardioid, in_bulb);
+        lane_periodic_iterations = V::select_i(interior, V::splat_i(0), lane_periodic_iterations);
+        active = V::mask_andnot(active, interior);
+    }
+
+    // Brent-style cycle detection: z is compared to a snapshot retaken at iterations 1, 2, 4, 8...
+    // A lane that comes back within the tolerance of it has settled on an attracting cycle and will never escape.
+    // A tolerance of 0 turns the check off, since the distance is never negative.
+    const F tolerance = V::splat(params.periodicity_tolerance);
+    F snapshot_real = z_real;
+    F snapshot_imag = z_imag;
+    int next_snapshot = 1;
+
+    // Initialize the iteration counter
+    int iterations = 0;
+
+    // Iterate until the maximum number of iterations is reached or every lane has escaped
+    while (++iterations < params.max_iterations) {
+        // Apply the formula and add c
+        F z_real_temp = z_real;
+        F z_imag_temp = z_imag;
+        Policy::template apply<V>(z_real_temp, z_imag_temp);
+        z_real_temp = V::add(z_real_temp, c_real);
+        z_imag_temp = V::add(z_imag_temp, c_imag);
+
+        // Update z only in the lanes that are still iterating
+        z_real = V::select(active, z_real_temp, z_real);
+        z_imag = V::select(active, z_imag_temp, z_imag);
+
+        // Check if z has escaped the circle of radius 2
+        const Mask out_of_bounds = V::mask_or(V::mask_or(V::gt(z_real, two), V::lt(z_real, neg_two)),
+                                              V::mask_or(V::gt(z_imag, two), V::lt(z_imag, neg_two)));
+
+        // Remember the iteration at which each lane escaped and retire it
+        const Mask escaped = V::mask_and(out_of_bounds, active);
+        lane_iterations = V::select_i(escaped, V::splat_i(iterations), lane_iterations);
+        active = V::mask_andnot(active, out_of_bounds);
+
+        // Retire the lanes that are back at their snapshot, using the cheaper L1 distance
+        const F distance = V::add(V::abs(V::sub(z_real, snapshot_real)), V::abs(V::sub(z_imag, snapshot_imag)));
+        const Mask periodic = V::mask_and(V::lt(distance, tolerance), active);
+        lane_periodic_iterations = V::select_i(periodic, V::splat_i(iterations), lane_periodic_iterations);
+        active = V::mask_andnot(active, periodic);
+
+        // If every lane has escaped or is periodic, break the loop
+        if (!V::any(active)) break;
+
+        if (iterations == next_snapshot) {
+            snapshot_real = z_real;
+            snapshot_imag = z_imag;
+            next_snapshot *= 2;
+        }
+    }
+
+    V::store(values, smooth_escape_value<V, Policy::exponent>(z_real, z_imag, lane_iterations, params.max_iterations));
+    V::store_i(iterations_out, lane_iterations);
+    V::store_i(periodic_iterations_out, lane_periodic_iterations);
+}
+
+// The kernels of every formula for one vector type, in FractalRenderer::Formula order
+template <typename V>
+constexpr KernelSet make_kernel_set(const char *isa) noexcept {
+    static_assert(V::lanes <= max_lanes);
+    return {isa,
+            V::lanes,
+            {
+                &escape_time<V, PowerFormula<2>, false>,
+                &escape_time<V, PowerFormula<3>, false>,
+                &escape_time<V, PowerFormula<2>, true>,
+                &escape_time<V, PowerFormula<3>, true>,
+                &escape_time<V, BurningShipFormula, true>,
+            }};
+}
+
+}  // namespace kernels
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef FORMULAS_HPP
+#define FORMULAS_HPP
+
+// Iteration formulas for the escape-time kernel template. Each policy maps the lanes of z to the next z before c is
+// added, for any vector type V of Vector.hpp, and is fully inlined into its own kernel instantiation, so the inner
+// loop never branches on the formula.
+
+// z^Exponent, by repeated complex multiplication
+template <int Exponent>
+struct PowerFormula {
+    static_assert(Exponent >= 2);
+    static constexpr int exponent = Exponent;
+
+    template <typename V>
+    static void apply(typename V::F &z_real, typename V::F &z_imag) noexcept {
+        if constexpr (Exponent == 2) {
+            const typename V::F real = V::sub(V::mul(z_real, z_real), V::mul(z_imag, z_imag));
+            z_imag = V::mul(V::mul(z_real, z_imag), V::splat(2.0f));
+            z_real = real;
+        } else {
+            typename V::F power_real = z_real;
+            typename V::F power_imag = z_imag;
+            for (int i = 1; i < Exponent; i++) {
+                const typename V::F real = V::sub(V::mul(power_real, z_real), V::mul(power_imag, z_imag));
+                power_imag = V::add(V::mul(power_real, z_imag), V::mul(power_imag, z_real));
+                power_real = real;
+            }
+            z_real = power_real;
+            z_imag = power_imag;
+        }
+    }
+};
+
+// (|Re z| + i |Im z|)^2, the Burning Ship
+struct BurningShipFormula {
+    static constexpr int exponent = 2;
+
+    template <typename V>
+    static void apply(typename V::F &z_real, typename V::F &z_imag) noexcept {
+        z_real = V::abs(z_real);
+        z_imag = V::abs(z_imag);
+        PowerFormula<2>::apply<V>(z_real, z_imag);
+    }
+};
+
+#endif
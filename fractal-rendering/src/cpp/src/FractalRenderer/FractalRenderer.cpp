@@ -0,0 +1,455 @@
+#include "FractalRenderer.hpp"
+
+#include "../Simd/Vector.hpp"
+#include "EscapeKernel.hpp"
+
+static_assert(FractalRenderer::formula_count == kernels::formula_count);
+
+const char *FractalRenderer::formula_name(Formula formula) noexcept {
+    switch (formula) {
+        case julia:
+            return "julia";
+        case julia_cubic:
+            return "julia_cubic";
+        case mandelbrot:
+            return "mandelbrot";
+        case mandelbrot_cubic:
+            return "mandelbrot_cubic";
+        case burning_ship:
+            return "burning_ship";
+        default:
+            return "unknown";
+    }
+}
+
+bool FractalRenderer::find_formula(const std::string& name, Formula& formula) noexcept {
+    for (int i = 0; i < formula_count; i++) {
+        if (name == formula_name(static_cast<Formula>(i))) {
+            formula = static_cast<Formula>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+FractalRenderer::FractalRenderer() { set_resolution(resolution_); }
+
+void FractalRenderer::set_resolution(const int& resolution) {
+    resolution_ = resolution;
+    layout_();
+}
+
+// The default view of the quadratic Julia set is symmetric about the origin, so only its right half is computed and
+// the rest is mirrored. The other formulas are at most symmetric about the real axis, which is not worth a second
+// layout.
+// Deeper than perturbation_threshold_ a float can no longer tell neighboring cells apart, so cells are computed as
+// offsets from reference orbits instead.
+void FractalRenderer::set_view(const View& view) {
+    view_ = view;
+    view_.half_height = std::clamp<double>(view_.half_height, get_min_half_height(), default_view_half_height);
+    mirrored_ = mirroring_enabled_ && formula_ == julia && view_ == View();
+    perturbed_ = formula_ == julia && view_.half_height < perturbation_threshold_;
+    layout_();
+}
+
+void FractalRenderer::set_mirroring(const bool& enabled) {
+    mirroring_enabled_ = enabled;
+    set_view(view_);
+}
+
+void FractalRenderer::set_formula(const Formula& formula) {
+    if (formula < 0 || formula >= formula_count || formula == formula_) return;
+    formula_ = formula;
+    set_view(view_);
+}
+
+double FractalRenderer::get_min_half_height() const noexcept {
+    return formula_ == julia ? min_half_height : perturbation_threshold_;
+}
+
+void FractalRenderer::layout_() {
+    grid_height_ = resolution_;
+    grid_width_ = mirrored_ ? resolution_ / 2 : resolution_;
+    if (grid_.width() != grid_width_ || grid_.height() != grid_height_) grid_.resize(grid_width_, grid_height_);
+    tiles_x_ = (grid_width_ + tile_size_ - 1) / tile_size_;
+    tiles_y_ = (grid_height_ + tile_size_ - 1) / tile_size_;
+
+    const double cell_size = 2.0 * view_.half_height / (grid_height_ - 1);
+    if (mirrored_) {
+        origin_x_ = 0.0f;
+        origin_y_ = -default_view_half_height;
+        cell_step_x_ = default_view_half_height / (grid_width_ - 1);
+        cell_step_y_ = 2.0f * default_view_half_height / (grid_height_ - 1);
+    } else if (perturbed_) {
+        origin_x_ = -(grid_width_ - 1) / 2.0f;
+        origin_y_ = -(grid_height_ - 1) / 2.0f;
+        cell_step_x_ = 1.0f;
+        cell_step_y_ = 1.0f;
+        delta_scale_ = static_cast<float>(cell_size);
+    } else {
+        origin_x_ = static_cast<float>(view_.center_x - view_.half_height);
+        origin_y_ = static_cast<float>(view_.center_y - view_.half_height);
+        cell_step_x_ = static_cast<float>(cell_size);
+        cell_step_y_ = static_cast<float>(cell_size);
+    }
+}
+
+void FractalRenderer::set_c(const float& c_real, const float& c_imag) noexcept {
+    c_real_ = c_real;
+    c_imag_ = c_imag;
+}
+
+void FractalRenderer::set_max_iterations(const int& max_iterations) noexcept {
+    max_iterations_ = std::max(2, max_iterations);
+}
+
+void FractalRenderer::set_thread_count(const std::size_t& thread_count) { pool_.set_thread_count(thread_count); }
+
+std::size_t FractalRenderer::get_thread_count() const noexcept { return pool_.get_thread_count(); }
+
+void FractalRenderer::set_profiler(Profiler* profiler) noexcept { profiler_ = profiler; }
+
+void FractalRenderer::set_periodicity_check(const bool& enabled) noexcept { periodicity_enabled_ = enabled; }
+
+bool FractalRenderer::set_kernel_isa(const std::string& isa) {
+    const kernels::KernelSet* set = kernels::find_kernel_set(isa);
+    if (!set) return false;
+    kernel_set_ = set;
+    return true;
+}
+
+std::vector<std::string> FractalRenderer::kernel_isas() {
+    std::vector<std::string> isas;
+    for (const kernels::KernelSet* set : kernels::supported_kernel_sets()) isas.emplace_back(set->isa);
+    return isas;
+}
+
+void FractalRenderer::set_subdivision(const bool& enabled) noexcept { subdivision_enabled_ = enabled; }
+
+void FractalRenderer::set_min_rectangle_size(const int& min_rectangle_size) noexcept {
+    min_rectangle_size_ = std::max(2, min_rectangle_size);
+}
+
+std::uint64_t FractalRenderer::get_iterations() const noexcept { return iterations_; }
+
+std::uint64_t FractalRenderer::get_saved_iterations() const noexcept { return saved_iterations_; }
+
+// The grid is split into tiles that are rendered as independent tasks on the worker pool, see subdivide_tile_
+void FractalRenderer::render() noexcept {
+    // every halving of the view needs a few more iterations to resolve the finer detail
+    frame_max_iterations_ = max_iterations_;
+    if (!mirrored_) {
+        const double octaves = std::max(0.0, std::log2(default_view_half_height / view_.half_height));
+        frame_max_iterations_ += static_cast<int>(iterations_per_octave_ * octaves);
+    }
+    if (perturbed_) compute_reference_orbits_();
+    // the grid may have been swapped for another one since the layout
+    if (grid_.width() != grid_width_ || grid_.height() != grid_height_) grid_.resize(grid_width_, grid_height_);
+    batch_ = kernel_set_->batches[formula_];
+    packet_lanes_ = perturbed_ ? Vector4::lanes : kernel_set_->lanes;
+    escape_params_ = {c_real_, c_imag_, frame_max_iterations_, periodicity_enabled_ ? periodicity_tolerance_ : 0.0f};
+    fill_enabled_ = subdivision_enabled_ && is_connected_();
+
+    iterations_ = 0;
+    saved_iterations_ = 0;
+    filled_cells_ = 0;
+    {
+        Profiler::Scope scope(profiler_, Profiler::subdivision);
+        pool_.run(static_cast<std::size_t>(tiles_x_) * tiles_y_, [&](std::size_t tile, std::size_t) {
+            const int x = static_cast<int>(tile % tiles_x_) * tile_size_;
+            const int y = static_cast<int>(tile / tiles_x_) * tile_size_;
+            subdivide_tile_(
+                {x, y, std::min(x + tile_size_, grid_width_) - 1, std::min(y + tile_size_, grid_height_) - 1});
+        });
+    }
+
+    if (profiler_) {
+        profiler_->add_count(Profiler::iterations, iterations_);
+        profiler_->add_count(Profiler::saved_iterations, saved_iterations_);
+        profiler_->add_count(Profiler::filled_cells, filled_cells_);
+    }
+}
+
+// Mariani-Silver subdivision with an explicit work stack. The border of every rectangle on the stack is already
+// computed. A rectangle whose border is uniformly interior (1) or uniformly fast escaping (0) encloses no detail when
+// the set has no holes and no islands (see is_connected_), so its inside is filled without being computed. Any other
+// rectangle is split into quadrants by computing a cross through its middle, until it is small enough that its inside
+// is cheaper to compute cell by cell. Sets that are not known to be connected are computed cell by cell throughout.
+// For a connected set every cell is either computed or filled with the exact value it would have, nothing is
+// interpolated; otherwise every cell is computed.
+void FractalRenderer::subdivide_tile_(const Rectangle& tile) noexcept {
+    PointPacket packet;
+    queue_border_(packet, tile);
+    flush_points_(packet);
+
+    std::vector<Rectangle> stack;
+    stack.reserve(16);
+    stack.push_back(tile);
+    std::uint64_t filled = 0;
+
+    while (!stack.empty()) {
+        const Rectangle rectangle = stack.back();
+        stack.pop_back();
+
+        const int width = rectangle.x1 - rectangle.x0;
+        const int height = rectangle.y1 - rectangle.y0;
+        if (width < 2 || height < 2) continue;
+
+        float value;
+        if (fill_enabled_ && is_border_uniform_(rectangle, value)) {
+            for (int y = rectangle.y0 + 1; y < rectangle.y1; y++) {
+                float* row = grid_.row(y);
+                std::fill(row + rectangle.x0 + 1, row + rectangle.x1, value);
+            }
+            filled += static_cast<std::uint64_t>(width - 1) * (height - 1);
+            continue;
+        }
+
+        // The inside of a rectangle is never the border of another one, so these points need no flush until the
+        // next cross
+        if (!fill_enabled_ || width <= min_rectangle_size_ || height <= min_rectangle_size_) {
+            for (int y = rectangle.y0 + 1; y < rectangle.y1; y++) {
+                for (int x = rectangle.x0 + 1; x < rectangle.x1; x++) queue_point_(packet, x, y);
+            }
+            continue;
+        }
+
+        const int x_middle = (rectangle.x0 + rectangle.x1) / 2;
+        const int y_middle = (rectangle.y0 + rectangle.y1) / 2;
+        for (int x = rectangle.x0 + 1; x < rectangle.x1; x++) queue_point_(packet, x, y_middle);
+        for (int y = rectangle.y0 + 1; y < rectangle.y1; y++) {
+            if (y != y_middle) queue_point_(packet, x_middle, y);
+        }
+        flush_points_(packet);
+
+        stack.push_back({rectangle.x0, rectangle.y0, x_middle, y_middle});
+        stack.push_back({x_middle, rectangle.y0, rectangle.x1, y_middle});
+        stack.push_back({rectangle.x0, y_middle, x_middle, rectangle.y1});
+        stack.push_back({x_middle, y_middle, rectangle.x1, rectangle.y1});
+    }
+
+    finish_points_(packet);
+    if (filled) filled_cells_ += filled;
+}
+
+void FractalRenderer::queue_border_(PointPacket& packet, const Rectangle& rectangle) noexcept {
+    for (int x = rectangle.x0; x <= rectangle.x1; x++) {
+        queue_point_(packet, x, rectangle.y0);
+        if (rectangle.y1 != rectangle.y0) queue_point_(packet, x, rectangle.y1);
+    }
+    for (int y = rectangle.y0 + 1; y < rectangle.y1; y++) {
+        queue_point_(packet, rectangle.x0, y);
+        if (rectangle.x1 != rectangle.x0) queue_point_(packet, rectangle.x1, y);
+    }
+}
+
+bool FractalRenderer::is_border_uniform_(const Rectangle& rectangle, float& value) const noexcept {
+    value = grid_(rectangle.x0, rectangle.y0);
+    if (value != 0.0f && value != 1.0f) return false;
+
+    for (int x = rectangle.x0; x <= rectangle.x1; x++) {
+        if (grid_(x, rectangle.y0) != value || grid_(x, rectangle.y1) != value) return false;
+    }
+    for (int y = rectangle.y0 + 1; y < rectangle.y1; y++) {
+        if (grid_(rectangle.x0, y) != value || grid_(rectangle.x1, y) != value) return false;
+    }
+    return true;
+}
+
+// Filling a rectangle from its border is only exact for a set whose every escape time band is connected and has no
+// holes. The Mandelbrot and Multibrot sets are; the Burning Ship has islands off its main body. A filled Julia set is
+// connected exactly when the orbit of its critical point 0 stays bounded, and otherwise it is dust, so the orbit is
+// iterated up to the cap of the frame the same way the kernels do.
+bool FractalRenderer::is_connected_() const noexcept {
+    switch (formula_) {
+        case julia:
+        case julia_cubic: {
+            double z_real = 0.0, z_imag = 0.0;
+            for (int i = 0; i < frame_max_iterations_; i++) {
+                const double square_real = z_real * z_real - z_imag * z_imag;
+                const double square_imag = 2.0 * z_real * z_imag;
+                if (formula_ == julia) {
+                    z_real = square_real + c_real_;
+                    z_imag = square_imag + c_imag_;
+                } else {
+                    const double cube_real = square_real * z_real - square_imag * z_imag;
+                    z_imag = square_real * z_imag + square_imag * z_real + c_imag_;
+                    z_real = cube_real + c_real_;
+                }
+                if (z_real * z_real + z_imag * z_imag > 4.0) return false;
+            }
+            return true;
+        }
+        case mandelbrot:
+        case mandelbrot_cubic:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Adds a point to the packet and evaluates the packet once all of its lanes are taken
+inline void FractalRenderer::queue_point_(PointPacket& packet, int x, int y) noexcept {
+    packet.cells[packet.size] = &grid_(x, y);
+    packet.xs[packet.size] = origin_x_ + cell_step_x_ * x;
+    packet.ys[packet.size] = origin_y_ + cell_step_y_ * y;
+    if (++packet.size == packet_lanes_) flush_points_(packet);
+}
+
+// Evaluates the queued points in one kernel call and writes the results to their cells
+void FractalRenderer::flush_points_(PointPacket& packet) noexcept {
+    if (!packet.size) return;
+
+    // Unused lanes repeat the first point so they never keep the loop running longer than the real ones
+    for (int lane = packet.size; lane < packet_lanes_; lane++) {
+        packet.xs[lane] = packet.xs[0];
+        packet.ys[lane] = packet.ys[0];
+    }
+
+    alignas(64) float values[PointPacket::lanes];
+    alignas(64) std::int32_t iterations[PointPacket::lanes];
+    alignas(64) std::int32_t periodic_iterations[PointPacket::lanes];
+    if (perturbed_) {
+        v128_t lane_iterations;
+        v128_t lane_periodic_iterations;
+        const v128_t xs = wasm_v128_load(packet.xs);
+        const v128_t ys = wasm_v128_load(packet.ys);
+        wasm_v128_store(values, is_in_set_perturbed_(xs, ys, lane_iterations, lane_periodic_iterations));
+        wasm_v128_store(iterations, lane_iterations);
+        wasm_v128_store(periodic_iterations, lane_periodic_iterations);
+    } else {
+        batch_(escape_params_, packet.xs, packet.ys, values, iterations, periodic_iterations);
+    }
+
+    // Lanes retired by cycle detection report the cap as their iteration count, but only ran until detection
+    for (int lane = 0; lane < packet.size; lane++) {
+        *packet.cells[lane] = values[lane];
+        packet.iterations += std::min(iterations[lane], periodic_iterations[lane]);
+        packet.saved_iterations += frame_max_iterations_ - periodic_iterations[lane];
+    }
+    packet.size = 0;
+}
+
+// Evaluates the points left in the packet and publishes its counters to the frame totals
+void FractalRenderer::finish_points_(PointPacket& packet) noexcept {
+    flush_points_(packet);
+    if (packet.iterations) iterations_ += packet.iterations;
+    if (packet.saved_iterations) saved_iterations_ += packet.saved_iterations;
+    packet.iterations = 0;
+    packet.saved_iterations = 0;
+}
+
+// Same as kernels::escape_time for the quadratic Julia set on four lanes, but x and y are offsets in cells from the
+// view center, and every lane follows a reference orbit with z = Z + delta_scale_ * delta, where only the small delta
+// is iterated in float:
+//   delta <- (2 Z + delta_scale_ * delta) * delta
+// A lane is rebased onto the orbit of 0 (delta = z) once z gets closer to 0 than to its reference, which is where
+// the delta would lose its precision, or when its reference orbit has escaped.
+inline v128_t FractalRenderer::is_in_set_perturbed_(const v128_t& x, const v128_t& y, v128_t& lane_iterations,
+                                                    v128_t& lane_periodic_iterations) const noexcept {
+    const float* orbit_real = orbit_real_.data();
+    const float* orbit_imag = orbit_imag_.data();
+
+    const v128_t scale = wasm_f32x4_splat(delta_scale_);
+    const v128_t inverse_scale = wasm_f32x4_splat(1.0f / delta_scale_);
+    const v128_t zero = wasm_f32x4_splat(0.0f);
+    const v128_t two = wasm_f32x4_splat(2.0f);
+    const v128_t neg_two = wasm_f32x4_splat(-2.0f);
+    const v128_t one_index = wasm_i32x4_splat(1);
+    const v128_t zero_orbit_start = wasm_i32x4_splat(center_orbit_length_);
+    const v128_t zero_orbit_end = wasm_i32x4_splat(static_cast<int>(orbit_real_.size()));
+
+    // Every lane starts on the orbit of the view center
+    v128_t delta_real = x;
+    v128_t delta_imag = y;
+    v128_t reference = wasm_i32x4_splat(0);
+    v128_t reference_end = wasm_i32x4_splat(center_orbit_length_);
+    v128_t reference_real = wasm_f32x4_splat(orbit_real[0]);
+    v128_t reference_imag = wasm_f32x4_splat(orbit_imag[0]);
+    v128_t z_real = wasm_f32x4_add(reference_real, wasm_f32x4_mul(scale, delta_real));
+    v128_t z_imag = wasm_f32x4_add(reference_imag, wasm_f32x4_mul(scale, delta_imag));
+
+    v128_t active = wasm_i32x4_splat(-1);
+    lane_iterations = wasm_i32x4_splat(frame_max_iterations_);
+    lane_periodic_iterations = lane_iterations;
+
+    int iterations = 0;
+    while (++iterations < frame_max_iterations_) {
+        // Rebase the lanes whose z is closer to 0 than to the reference, or whose reference has no next point
+        const v128_t scaled_delta_real = wasm_f32x4_mul(scale, delta_real);
+        const v128_t scaled_delta_imag = wasm_f32x4_mul(scale, delta_imag);
+        const v128_t z_norm = wasm_f32x4_add(wasm_f32x4_mul(z_real, z_real), wasm_f32x4_mul(z_imag, z_imag));
+        const v128_t delta_norm = wasm_f32x4_add(wasm_f32x4_mul(scaled_delta_real, scaled_delta_real),
+                                                 wasm_f32x4_mul(scaled_delta_imag, scaled_delta_imag));
+        const v128_t closer_to_zero = wasm_v128_and(active, wasm_f32x4_lt(z_norm, delta_norm));
+        const v128_t exhausted =
+            wasm_v128_andnot(active, wasm_i32x4_lt(wasm_i32x4_add(reference, one_index), reference_end));
+        const v128_t rebase = wasm_v128_or(closer_to_zero, exhausted);
+
+        delta_real = wasm_v128_bitselect(wasm_f32x4_mul(z_real, inverse_scale), delta_real, rebase);
+        delta_imag = wasm_v128_bitselect(wasm_f32x4_mul(z_imag, inverse_scale), delta_imag, rebase);
+        reference = wasm_v128_bitselect(zero_orbit_start, reference, rebase);
+        reference_end = wasm_v128_bitselect(zero_orbit_end, reference_end, rebase);
+        reference_real = wasm_v128_bitselect(zero, reference_real, rebase);
+        reference_imag = wasm_v128_bitselect(zero, reference_imag, rebase);
+
+        // Advance the delta of the lanes that are still iterating
+        const v128_t a = wasm_f32x4_add(wasm_f32x4_mul(two, reference_real), wasm_f32x4_mul(scale, delta_real));
+        const v128_t b = wasm_f32x4_add(wasm_f32x4_mul(two, reference_imag), wasm_f32x4_mul(scale, delta_imag));
+        const v128_t next_delta_real = wasm_f32x4_sub(wasm_f32x4_mul(a, delta_real), wasm_f32x4_mul(b, delta_imag));
+        const v128_t next_delta_imag = wasm_f32x4_add(wasm_f32x4_mul(a, delta_imag), wasm_f32x4_mul(b, delta_real));
+        delta_real = wasm_v128_bitselect(next_delta_real, delta_real, active);
+        delta_imag = wasm_v128_bitselect(next_delta_imag, delta_imag, active);
+        reference = wasm_v128_bitselect(wasm_i32x4_add(reference, one_index), reference, active);
+
+        // Gather the next reference point of every lane
+        const int r0 = wasm_i32x4_extract_lane(reference, 0);
+        const int r1 = wasm_i32x4_extract_lane(reference, 1);
+        const int r2 = wasm_i32x4_extract_lane(reference, 2);
+        const int r3 = wasm_i32x4_extract_lane(reference, 3);
+        reference_real = wasm_f32x4_make(orbit_real[r0], orbit_real[r1], orbit_real[r2], orbit_real[r3]);
+        reference_imag = wasm_f32x4_make(orbit_imag[r0], orbit_imag[r1], orbit_imag[r2], orbit_imag[r3]);
+
+        z_real = wasm_v128_bitselect(wasm_f32x4_add(reference_real, wasm_f32x4_mul(scale, delta_real)), z_real, active);
+        z_imag = wasm_v128_bitselect(wasm_f32x4_add(reference_imag, wasm_f32x4_mul(scale, delta_imag)), z_imag, active);
+
+        const v128_t out_of_bounds =
+            wasm_v128_or(wasm_v128_or(wasm_f32x4_gt(z_real, two), wasm_f32x4_lt(z_real, neg_two)),
+                         wasm_v128_or(wasm_f32x4_gt(z_imag, two), wasm_f32x4_lt(z_imag, neg_two)));
+
+        const v128_t escaped = wasm_v128_and(out_of_bounds, active);
+        lane_iterations = wasm_v128_bitselect(wasm_i32x4_splat(iterations), lane_iterations, escaped);
+        active = wasm_v128_andnot(active, out_of_bounds);
+
+        if (!wasm_v128_any_true(active)) break;
+    }
+
+    return kernels::smooth_escape_value<Vector4, 2>(z_real, z_imag, lane_iterations, frame_max_iterations_);
+}
+
+// Iterates the view center and 0 in double-double precision into one array, the center orbit first.
+// Each orbit ends with its first escaped point and has at least two points, so a rebased lane always has a next one.
+void FractalRenderer::compute_reference_orbits_() {
+    orbit_real_.clear();
+    orbit_imag_.clear();
+    append_reference_orbit_(view_.center_x, view_.center_y);
+    center_orbit_length_ = static_cast<int>(orbit_real_.size());
+    append_reference_orbit_(0.0, 0.0);
+}
+
+void FractalRenderer::append_reference_orbit_(DoubleDouble z_real, DoubleDouble z_imag) {
+    const DoubleDouble c_real = c_real_;
+    const DoubleDouble c_imag = c_imag_;
+
+    for (int i = 0; i <= frame_max_iterations_; i++) {
+        const float real = static_cast<float>(z_real);
+        const float imag = static_cast<float>(z_imag);
+        orbit_real_.push_back(real);
+        orbit_imag_.push_back(imag);
+        if (i > 0 && (std::abs(real) > 2.0f || std::abs(imag) > 2.0f)) break;
+
+        const DoubleDouble next_real = z_real * z_real - z_imag * z_imag + c_real;
+        z_imag = DoubleDouble(2.0) * z_real * z_imag + c_imag;
+        z_real = next_real;
+    }
+}
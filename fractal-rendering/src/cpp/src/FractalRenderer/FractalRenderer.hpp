@@ -0,0 +1,181 @@
+#ifndef FRACTAL_RENDERER_HPP
+#define FRACTAL_RENDERER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../DoubleDouble/DoubleDouble.hpp"
+#include "../Grid/Grid.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Simd/Simd.hpp"
+#include "../WorkerPool/WorkerPool.hpp"
+#include "Kernels.hpp"
+
+// Computes a square view of a Julia, Mandelbrot or Burning Ship set into a grid of smooth escape values in [0, 1].
+// For the default view of the quadratic Julia set only the right half is computed: the left half is its point
+// reflection, so callers mirror the grid instead (see is_mirrored).
+// Has no windowing or browser dependencies, so it is shared by the app and the native benchmark.
+class FractalRenderer {
+   public:
+    static constexpr float default_view_half_height = 2.0f;
+    // delta_scale_ has to stay a normal float
+    static constexpr double min_half_height = 1e-34;
+
+    // Julia formulas iterate every cell from z = cell with the constant c, Mandelbrot-like ones from z = 0 with
+    // c = cell
+    enum Formula { julia, julia_cubic, mandelbrot, mandelbrot_cubic, burning_ship, formula_count };
+    static const char *formula_name(Formula formula) noexcept;
+    // Returns false when no formula has that name
+    static bool find_formula(const std::string &name, Formula &formula) noexcept;
+
+    // Grid columns run along the real axis and rows along the imaginary one
+    struct View {
+        DoubleDouble center_x = 0.0;
+        DoubleDouble center_y = 0.0;
+        double half_height = default_view_half_height;
+
+        bool operator==(const View &other) const noexcept = default;
+    };
+
+    FractalRenderer();
+
+    // The grid is resolution cells tall
+    void set_resolution(const int &resolution);
+    void set_view(const View &view);
+    const View &get_view() const noexcept { return view_; }
+    bool is_mirrored() const noexcept { return mirrored_; }
+    // Computes the default view as a whole even where it could be mirrored
+    void set_mirroring(const bool &enabled);
+    void set_formula(const Formula &formula);
+    Formula get_formula() const noexcept { return formula_; }
+    // Only the quadratic Julia set has a perturbation kernel; the others stop zooming where float runs out
+    double get_min_half_height() const noexcept;
+    void set_c(const float &c_real, const float &c_imag) noexcept;
+    void set_max_iterations(const int &max_iterations) noexcept;
+    int get_max_iterations() const noexcept { return max_iterations_; }
+    void render() noexcept;
+
+    // Every cell is written by each render, so the grid can be swapped for another one between renders
+    Grid &grid() noexcept { return grid_; }
+    const Grid &grid() const noexcept { return grid_; }
+    int get_resolution() const noexcept { return resolution_; }
+
+    void set_thread_count(const std::size_t &thread_count);
+    std::size_t get_thread_count() const noexcept;
+    // Stage timings and counters of every render are added to the profiler's current frame; nullptr disables them
+    void set_profiler(Profiler *profiler) noexcept;
+    // Without subdivision every cell is computed, which is the reference the filled cells are checked against.
+    // Subdivision only applies to sets known to be connected; the others are always computed cell by cell.
+    // Rectangles with a side of at most min_rectangle_size cells (2 or more) are computed instead of subdivided.
+    void set_subdivision(const bool &enabled) noexcept;
+    void set_min_rectangle_size(const int &min_rectangle_size) noexcept;
+    // Vector instruction set of the kernels, by default the widest one this CPU supports (see Kernels.hpp); returns
+    // false when the name is not one of kernel_isas()
+    bool set_kernel_isa(const std::string &isa);
+    const char *get_kernel_isa() const noexcept { return kernel_set_->isa; }
+    static std::vector<std::string> kernel_isas();
+    // Stops iterating points whose orbit has settled on a cycle; not applied to perturbed views, where neighboring
+    // points are closer than any usable tolerance
+    void set_periodicity_check(const bool &enabled) noexcept;
+
+    // counters of the last rendered frame
+    std::uint64_t get_iterations() const noexcept;
+    // iterations that points proven periodic did not have to run up to the cap
+    std::uint64_t get_saved_iterations() const noexcept;
+
+   private:
+    int grid_height_ = 0;
+    int grid_width_ = 0;
+    Grid grid_;
+
+    // square tiles of tile_size_ cells, rendered as independent tasks on the worker pool; rectangles with a side of at
+    // most min_rectangle_size_ cells are computed cell by cell instead of being subdivided further
+    WorkerPool pool_;
+    static constexpr int tile_size_ = 64;
+    bool subdivision_enabled_ = true;
+    // subdivision_enabled_ for a set that is connected, decided once per frame
+    bool fill_enabled_ = true;
+    int min_rectangle_size_ = 8;
+    int tiles_x_ = 0;
+    int tiles_y_ = 0;
+    std::atomic<std::uint64_t> filled_cells_ = 0;
+
+    // inclusive cell bounds
+    struct Rectangle {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    std::atomic<std::uint64_t> iterations_ = 0;
+    std::atomic<std::uint64_t> saved_iterations_ = 0;
+    Profiler *profiler_ = nullptr;
+
+    int resolution_ = 600;
+
+    View view_;
+    Formula formula_ = julia;
+    bool mirroring_enabled_ = true;
+    bool mirrored_ = true;
+    bool perturbed_ = false;
+    double perturbation_threshold_ = 1e-3;
+    // coordinates of cell (0, 0) and the distance between cells; when perturbed they are offsets from the view center
+    // in cells, and delta_scale_ is the size of a cell
+    float origin_x_ = 0.0f;
+    float origin_y_ = 0.0f;
+    float cell_step_x_ = 0.0f;
+    float cell_step_y_ = 0.0f;
+    float delta_scale_ = 1.0f;
+
+    // orbits of the view center and of 0 back to back, for perturbation
+    std::vector<float> orbit_real_;
+    std::vector<float> orbit_imag_;
+    int center_orbit_length_ = 0;
+
+    bool periodicity_enabled_ = true;
+    float periodicity_tolerance_ = 1e-5f;
+
+    int max_iterations_ = 50;
+    int iterations_per_octave_ = 8;
+    int frame_max_iterations_ = 50;
+    float c_real_ = 0.0f;
+    float c_imag_ = 0.0f;
+
+    // points collected for a single kernel call, one per SIMD lane; packets are flushed at packet_lanes_ points
+    struct PointPacket {
+        static constexpr int lanes = kernels::max_lanes;
+        alignas(64) float xs[lanes];
+        alignas(64) float ys[lanes];
+        float *cells[lanes];
+        int size = 0;
+        std::uint64_t iterations = 0;
+        std::uint64_t saved_iterations = 0;
+    };
+
+    // the batch kernel is picked once per frame from kernel_set_, indexed by formula; perturbed views run
+    // is_in_set_perturbed_ instead, four lanes at a time
+    const kernels::KernelSet *kernel_set_ = &kernels::default_kernel_set();
+    kernels::Batch batch_ = nullptr;
+    kernels::EscapeParams escape_params_;
+    int packet_lanes_ = 4;
+
+    void layout_();
+    void subdivide_tile_(const Rectangle &tile) noexcept;
+    void queue_border_(PointPacket &packet, const Rectangle &rectangle) noexcept;
+    bool is_border_uniform_(const Rectangle &rectangle, float &value) const noexcept;
+    bool is_connected_() const noexcept;
+    void queue_point_(PointPacket &packet, int x, int y) noexcept;
+    void flush_points_(PointPacket &packet) noexcept;
+    void finish_points_(PointPacket &packet) noexcept;
+    v128_t is_in_set_perturbed_(const v128_t &x, const v128_t &y, v128_t &lane_iterations,
+                                v128_t &lane_periodic_iterations) const noexcept;
+    void compute_reference_orbits_();
+    void append_reference_orbit_(DoubleDouble z_real, DoubleDouble z_imag);
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "Kernels.hpp"
+
+#include "../Simd/Vector.hpp"
+#include "EscapeKernel.hpp"
+
+namespace kernels {
+
+namespace {
+
+const KernelSet baseline_kernel_set = make_kernel_set<Vector4>(simd_backend);
+
+}  // namespace
+
+// Defined in their own translation units, built with the instruction set enabled
+#if FLOW_KERNELS_AVX512
+extern const KernelSet avx512_kernel_set;
+#endif
+#if FLOW_KERNELS_AVX2
+extern const KernelSet avx2_kernel_set;
+#endif
+
+// __builtin_cpu_supports also checks that the OS saves the wider registers
+std::vector<const KernelSet *> supported_kernel_sets() {
+    std::vector<const KernelSet *> sets;
+#if FLOW_KERNELS_AVX512
+    if (__builtin_cpu_supports("avx512f")) sets.push_back(&avx512_kernel_set);
+#endif
+#if FLOW_KERNELS_AVX2
+    if (__builtin_cpu_supports("avx2")) sets.push_back(&avx2_kernel_set);
+#endif
+    sets.push_back(&baseline_kernel_set);
+    return sets;
+}
+
+const KernelSet &default_kernel_set() {
+    static const KernelSet *const set = supported_kernel_sets().front();
+    return *set;
+}
+
+const KernelSet *find_kernel_set(const std::string &isa) {
+    for (const KernelSet *set : supported_kernel_sets()) {
+        if (isa == set->isa) return set;
+    }
+    return nullptr;
+}
+
+}  // namespace kernels
@@ -0,0 +1,48 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Escape-time kernels of FractalRenderer, built once per vector instruction set from EscapeKernel.hpp.
+// Native x86 builds carry AVX2 and AVX-512 sets next to the baseline one and pick the widest the CPU supports at
+// startup; the browser build only has the wasm SIMD baseline.
+namespace kernels {
+
+// Constants of a frame, shared by every call
+struct EscapeParams {
+    float c_real = 0.0f;
+    float c_imag = 0.0f;
+    int max_iterations = 50;
+    // 0 turns the cycle detection off
+    float periodicity_tolerance = 0.0f;
+};
+
+// Iterates one point per lane from xs and ys and writes, per lane, the smooth escape value, the iteration at which it
+// escaped (max_iterations if it never did) and the one at which it was proven periodic (max_iterations if it never
+// was). Every array holds the set's lanes elements.
+using Batch = void (*)(const EscapeParams &params, const float *xs, const float *ys, float *values,
+                       std::int32_t *iterations, std::int32_t *periodic_iterations) noexcept;
+
+// Indexed like FractalRenderer::Formula
+inline constexpr int formula_count = 5;
+
+struct KernelSet {
+    const char *isa;
+    int lanes;
+    Batch batches[formula_count];
+};
+
+// The widest lane count of any set, for sizing point buffers
+inline constexpr int max_lanes = 16;
+
+// Sets built into this binary that this CPU can run, widest first; the last one is the baseline
+std::vector<const KernelSet *> supported_kernel_sets();
+const KernelSet &default_kernel_set();
+// nullptr when no supported set has that name
+const KernelSet *find_kernel_set(const std::string &isa);
+
+}  // namespace kernels
+
+#endif
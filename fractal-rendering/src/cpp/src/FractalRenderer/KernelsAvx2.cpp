@@ -0,0 +1,11 @@
+// Built with -mavx2 -ffp-contract=off, see CMakeLists.txt. Contraction into FMA stays off: a fused multiply-add
+// rounds once where the other sets round twice, and every set has to render bit-identical images.
+
+#include "../Simd/VectorAvx2.hpp"
+#include "EscapeKernel.hpp"
+
+namespace kernels {
+
+extern const KernelSet avx2_kernel_set = make_kernel_set<Vector8>("avx2");
+
+}  // namespace kernels
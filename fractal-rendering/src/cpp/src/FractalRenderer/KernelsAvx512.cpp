@@ -0,0 +1,10 @@
+// Built with -mavx512f -ffp-contract=off, see CMakeLists.txt and KernelsAvx2.cpp.
+
+#include "../Simd/VectorAvx512.hpp"
+#include "EscapeKernel.hpp"
+
+namespace kernels {
+
+extern const KernelSet avx512_kernel_set = make_kernel_set<Vector16>("avx512");
+
+}  // namespace kernels
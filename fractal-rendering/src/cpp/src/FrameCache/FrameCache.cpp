@@ -0,0 +1,164 @@
+#include "FrameCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+namespace {
+
+// 0 and 1 keep codes of their own, since the palette draws exactly those values black; the values in between are
+// split into gradient_codes equal bins, decoded to their middle so they never round to an end
+constexpr std::uint8_t escaped_code = 0;
+constexpr std::uint8_t interior_code = 255;
+constexpr float gradient_codes = 254.0f;
+
+std::uint8_t quantize(float t) noexcept {
+    if (t <= 0.0f) return escaped_code;
+    if (t >= 1.0f) return interior_code;
+    return static_cast<std::uint8_t>(1.0f + std::min(t * gradient_codes, gradient_codes - 1.0f));
+}
+
+float dequantize(std::uint8_t code) noexcept {
+    if (code == escaped_code) return 0.0f;
+    if (code == interior_code) return 1.0f;
+    return (code - 0.5f) / gradient_codes;
+}
+
+// PackBits: a control byte n below 128 is followed by n + 1 literal bytes, and one from 128 up by a single byte that
+// repeats n - 125 times, so runs of 3 to 130 cells take 2 bytes
+constexpr int max_literal = 128;
+constexpr int min_run = 3;
+constexpr int max_run = 130;
+
+}  // namespace
+
+std::size_t FrameCache::KeyHash::operator()(const Key &key) const noexcept {
+    std::size_t hash = static_cast<std::size_t>(key.slot);
+    for (const int value : {key.width, key.height, key.max_iterations})
+        hash = hash * 1000003 ^ static_cast<std::size_t>(value);
+    return hash;
+}
+
+void FrameCache::set_budget(const std::size_t &bytes) {
+    budget_ = bytes;
+    evict_();
+}
+
+bool FrameCache::load(const Key &key, Grid &grid) {
+    const auto found = index_.find(key);
+    if (found == index_.end()) return false;
+
+    frames_.splice(frames_.begin(), frames_, found->second);
+    if (grid.width() != key.width || grid.height() != key.height) grid.resize(key.width, key.height);
+    decode_(found->second->data, grid);
+    return true;
+}
+
+// A frame that only fits by evicting frames of its own configuration is dropped instead: the animation comes back
+// to its frames in a loop, so a loop that does not fit would otherwise evict every frame just before it is needed
+void FrameCache::store(const Key &key, const Grid &grid) {
+    encode_(grid);
+
+    const auto found = index_.find(key);
+    if (found != index_.end()) erase_(found->second);
+
+    for (auto frame = frames_.end(); size_ + encoded_.size() > budget_ && frame != frames_.begin();) {
+        --frame;
+        if (!same_configuration_(frame->key, key)) frame = erase_(frame);
+    }
+    if (size_ + encoded_.size() > budget_) return;
+
+    frames_.push_front({key, std::vector<std::uint8_t>(encoded_.begin(), encoded_.end())});
+    index_.emplace(key, frames_.begin());
+    size_ += encoded_.size();
+}
+
+void FrameCache::clear() noexcept {
+    frames_.clear();
+    index_.clear();
+    size_ = 0;
+}
+
+void FrameCache::evict_() {
+    while (size_ > budget_ && !frames_.empty()) erase_(std::prev(frames_.end()));
+}
+
+std::list<FrameCache::Frame>::iterator FrameCache::erase_(std::list<Frame>::iterator frame) {
+    size_ -= frame->data.size();
+    index_.erase(frame->key);
+    return frames_.erase(frame);
+}
+
+bool FrameCache::same_configuration_(const Key &a, const Key &b) noexcept {
+    return a.width == b.width && a.height == b.height && a.max_iterations == b.max_iterations;
+}
+
+// Quantizes the cells row by row, skipping the row padding, then packs the whole grid as one stream
+void FrameCache::encode_(const Grid &grid) {
+    const std::size_t width = static_cast<std::size_t>(grid.width());
+    quantized_.resize(width * grid.height());
+    for (int y = 0; y < grid.height(); y++) {
+        const float *row = grid.row(y);
+        std::uint8_t *codes = quantized_.data() + y * width;
+        for (std::size_t x = 0; x < width; x++) codes[x] = quantize(row[x]);
+    }
+
+    encoded_.clear();
+    const std::uint8_t *codes = quantized_.data();
+    const std::size_t count = quantized_.size();
+    std::size_t i = 0;
+    while (i < count) {
+        std::size_t run = 1;
+        while (i + run < count && run < max_run && codes[i + run] == codes[i]) run++;
+        if (run >= min_run) {
+            encoded_.push_back(static_cast<std::uint8_t>(run + 125));
+            encoded_.push_back(codes[i]);
+            i += run;
+            continue;
+        }
+
+        // literals continue up to the next run worth packing
+        const std::size_t start = i;
+        while (i < count && i - start < max_literal) {
+            if (i + 2 < count && codes[i] == codes[i + 1] && codes[i] == codes[i + 2]) break;
+            i++;
+        }
+        encoded_.push_back(static_cast<std::uint8_t>(i - start - 1));
+        encoded_.insert(encoded_.end(), codes + start, codes + i);
+    }
+}
+
+// Unpacks the stream into codes first, so the cells are then written row by row through a lookup table
+void FrameCache::decode_(const std::vector<std::uint8_t> &data, Grid &grid) {
+    const std::size_t width = static_cast<std::size_t>(grid.width());
+    const std::size_t count = width * grid.height();
+    quantized_.resize(count);
+
+    std::size_t cell = 0;
+    std::size_t i = 0;
+    while (i < data.size() && cell < count) {
+        const std::uint8_t control = data[i++];
+        if (control < max_literal) {
+            const std::size_t length = std::min({static_cast<std::size_t>(control) + 1, data.size() - i, count - cell});
+            std::copy_n(data.data() + i, length, quantized_.data() + cell);
+            i += control + 1;
+            cell += length;
+        } else if (i < data.size()) {
+            const std::size_t length = std::min<std::size_t>(control - 125, count - cell);
+            std::fill_n(quantized_.data() + cell, length, data[i++]);
+            cell += length;
+        }
+    }
+    std::fill(quantized_.data() + cell, quantized_.data() + count, escaped_code);
+
+    static const std::array<float, 256> values = [] {
+        std::array<float, 256> table;
+        for (int code = 0; code < 256; code++) table[code] = dequantize(static_cast<std::uint8_t>(code));
+        return table;
+    }();
+    for (int y = 0; y < grid.height(); y++) {
+        const std::uint8_t *codes = quantized_.data() + y * width;
+        float *row = grid.row(y);
+        for (std::size_t x = 0; x < width; x++) row[x] = values[codes[x]];
+    }
+}
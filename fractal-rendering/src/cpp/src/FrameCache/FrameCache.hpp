@@ -0,0 +1,69 @@
+#ifndef FRAME_CACHE_HPP
+#define FRAME_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "../Grid/Grid.hpp"
+
+// Rendered grids kept under a memory budget, least recently used first out, except that frames of the configuration
+// being stored are never evicted for it (see store).
+// Cells are stored as 8-bit codes of their escape values, compressed with PackBits, which collapses the long runs of
+// interior and quickly escaping cells; decoding unpacks the codes and maps them back through a table.
+class FrameCache {
+   public:
+    // Identifies a frame of the c animation: the animation slot and everything that changes the grid contents
+    struct Key {
+        int slot = 0;
+        int width = 0;
+        int height = 0;
+        int max_iterations = 0;
+
+        bool operator==(const Key &other) const noexcept = default;
+    };
+
+    static constexpr std::size_t default_budget = 64 << 20;
+
+    // Evicts the least recently used frames until the cache fits the new budget
+    void set_budget(const std::size_t &bytes);
+    std::size_t get_budget() const noexcept { return budget_; }
+
+    // Decodes the frame into grid and marks it as recently used; returns false when it is not cached
+    bool load(const Key &key, Grid &grid);
+    void store(const Key &key, const Grid &grid);
+    void clear() noexcept;
+
+    // compressed bytes of all cached frames
+    std::size_t get_size() const noexcept { return size_; }
+    std::size_t get_frame_count() const noexcept { return frames_.size(); }
+
+   private:
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const noexcept;
+    };
+
+    struct Frame {
+        Key key;
+        std::vector<std::uint8_t> data;
+    };
+
+    std::size_t budget_ = default_budget;
+    std::size_t size_ = 0;
+    // most recently used first
+    std::list<Frame> frames_;
+    std::unordered_map<Key, std::list<Frame>::iterator, KeyHash> index_;
+    // quantized cells and their encoding, reused between calls
+    std::vector<std::uint8_t> quantized_;
+    std::vector<std::uint8_t> encoded_;
+
+    void evict_();
+    std::list<Frame>::iterator erase_(std::list<Frame>::iterator frame);
+    static bool same_configuration_(const Key &a, const Key &b) noexcept;
+    void encode_(const Grid &grid);
+    void decode_(const std::vector<std::uint8_t> &data, Grid &grid);
+};
+
+#endif
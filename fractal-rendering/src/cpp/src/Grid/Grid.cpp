@@ -0,0 +1,21 @@
+#include "Grid.hpp"
+
+void Grid::resize(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    stride_ = (width_ + floats_per_alignment - 1) / floats_per_alignment * floats_per_alignment;
+
+    const std::size_t size = static_cast<std::size_t>(stride_) * height_;
+    if (size > capacity_) {
+        data_.reset(static_cast<float *>(::operator new[](size * sizeof(float), std::align_val_t(alignment))));
+        capacity_ = size;
+    }
+    fill(0.0f);
+}
+
+void Grid::fill(float value) noexcept { std::fill(data_.get(), data_.get() + stride_ * height_, value); }
+
+void Grid::copy_from(const Grid &other) {
+    if (width_ != other.width_ || height_ != other.height_) resize(other.width_, other.height_);
+    std::copy(other.data_.get(), other.data_.get() + stride_ * height_, data_.get());
+}
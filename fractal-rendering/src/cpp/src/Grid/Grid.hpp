@@ -0,0 +1,42 @@
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+// Row-major float grid in a single aligned allocation.
+// Rows start on alignment boundaries (the stride is padded), so whole rows can be loaded and stored as vectors.
+class Grid {
+   public:
+    static constexpr std::size_t alignment = 64;
+    static constexpr int floats_per_alignment = alignment / sizeof(float);
+
+    // Keeps the current allocation when it is large enough for the new size; all cells are reset to 0
+    void resize(int width, int height);
+    void fill(float value) noexcept;
+    void copy_from(const Grid &other);
+
+    float &operator()(int x, int y) noexcept { return data_.get()[y * stride_ + x]; }
+    const float &operator()(int x, int y) const noexcept { return data_.get()[y * stride_ + x]; }
+    float *row(int y) noexcept { return data_.get() + y * stride_; }
+    const float *row(int y) const noexcept { return data_.get() + y * stride_; }
+
+    int width() const noexcept { return width_; }
+    int height() const noexcept { return height_; }
+    int stride() const noexcept { return stride_; }
+
+   private:
+    struct AlignedDelete {
+        void operator()(float *data) const noexcept { ::operator delete[](data, std::align_val_t(alignment)); }
+    };
+
+    std::unique_ptr<float[], AlignedDelete> data_;
+    std::size_t capacity_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+    int stride_ = 0;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "Palette.hpp"
+
+Palette::Palette() { set_default(); }
+
+// Bernstein polynomial gradient from dark blue through green to red
+void Palette::set_default() noexcept {
+    for (std::size_t i = 0; i < size; i++) {
+        const float t = static_cast<float>(i) / (size - 1);
+        const float inverse_t = 1 - t;
+        const float t_squared = t * t;
+        const float t_cubed = t_squared * t;
+
+        const int r = static_cast<int>(9 * inverse_t * t_cubed * 255);
+        const int g = static_cast<int>(15 * inverse_t * inverse_t * t_squared * 255);
+        const int b = static_cast<int>(8.5 * inverse_t * inverse_t * inverse_t * t * 255);
+
+        colors_[i] = pack_color(r, g, b);
+    }
+    blacken_ends_();
+}
+
+// Linearly interpolates between the stops, holding the first and last stop colors past their positions
+void Palette::set_gradient(std::vector<Stop> stops) {
+    if (stops.empty()) return set_default();
+
+    std::stable_sort(stops.begin(), stops.end(),
+                     [](const Stop &a, const Stop &b) { return a.position < b.position; });
+
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        const float t = static_cast<float>(i) / (size - 1);
+        while (next < stops.size() && stops[next].position <= t) next++;
+
+        if (next == 0) {
+            colors_[i] = pack_color(stops.front().r, stops.front().g, stops.front().b);
+        } else if (next == stops.size()) {
+            colors_[i] = pack_color(stops.back().r, stops.back().g, stops.back().b);
+        } else {
+            const Stop &from = stops[next - 1];
+            const Stop &to = stops[next];
+            const float progress = (t - from.position) / (to.position - from.position);
+            colors_[i] = pack_color(static_cast<int>(from.r + (to.r - from.r) * progress),
+                                    static_cast<int>(from.g + (to.g - from.g) * progress),
+                                    static_cast<int>(from.b + (to.b - from.b) * progress));
+        }
+    }
+    blacken_ends_();
+}
+
+void Palette::map(const float *t, std::uint32_t *colors, std::size_t count) const noexcept {
+    const v128_t scale = wasm_f32x4_splat(static_cast<float>(size - 1));
+    const v128_t half = wasm_f32x4_splat(0.5f);
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const v128_t indices =
+            wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_add(wasm_f32x4_mul(wasm_v128_load(t + i), scale), half));
+        colors[i] = colors_[wasm_i32x4_extract_lane(indices, 0)];
+        colors[i + 1] = colors_[wasm_i32x4_extract_lane(indices, 1)];
+        colors[i + 2] = colors_[wasm_i32x4_extract_lane(indices, 2)];
+        colors[i + 3] = colors_[wasm_i32x4_extract_lane(indices, 3)];
+    }
+    for (; i < count; i++) colors[i] = color(t[i]);
+}
+
+void Palette::map_grid(const Grid &grid, const bool &mirrored, std::uint32_t *pixels,
+                       std::size_t pitch) const noexcept {
+    const int width = grid.width();
+    const int height = grid.height();
+    for (int y = 0; y < height; y++) {
+        std::uint32_t *row = pixels + y * pitch + (mirrored ? width : 0);
+        map(grid.row(y), row, width);
+
+        if (!mirrored) continue;
+        std::uint32_t *mirrored_row = pixels + (height - 1 - y) * pitch;
+        std::reverse_copy(row, row + width, mirrored_row);
+    }
+}
+
+void Palette::blacken_ends_() noexcept {
+    colors_.front() = pack_color(0, 0, 0);
+    colors_.back() = pack_color(0, 0, 0);
+}
@@ -0,0 +1,51 @@
+#ifndef PALETTE_HPP
+#define PALETTE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Grid/Grid.hpp"
+#include "../Simd/Simd.hpp"
+
+// Lookup table from a smooth escape value t in [0, 1] to a packed ARGB8888 color.
+// t == 0 (escaped immediately) and t == 1 (never escaped) are always black.
+class Palette {
+   public:
+    static constexpr std::size_t size = 4096;
+
+    // gradient key color at a position in [0, 1]
+    struct Stop {
+        float position;
+        std::uint8_t r, g, b;
+    };
+
+    Palette();
+
+    void set_default() noexcept;
+    void set_gradient(std::vector<Stop> stops);
+
+    std::uint32_t color(const float &t) const noexcept {
+        return colors_[static_cast<std::size_t>(t * (size - 1) + 0.5f)];
+    }
+
+    // Colors count values at once, computing the table indices four at a time
+    void map(const float *t, std::uint32_t *colors, std::size_t count) const noexcept;
+    // Colors a grid into an image whose rows start pitch pixels apart. A mirrored grid is the right half of the image,
+    // and is point reflected onto the left half, so the image is then twice as wide as the grid.
+    void map_grid(const Grid &grid, const bool &mirrored, std::uint32_t *pixels, std::size_t pitch) const noexcept;
+
+   private:
+    std::array<std::uint32_t, size> colors_;
+
+    void blacken_ends_() noexcept;
+};
+
+inline std::uint32_t pack_color(int r, int g, int b) noexcept {
+    return 0xFF000000 | (static_cast<std::uint32_t>(r) << 16) | (static_cast<std::uint32_t>(g) << 8) |
+           static_cast<std::uint32_t>(b);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "Profiler.hpp"
+
+const char *Profiler::stage_name(Stage stage) noexcept {
+    switch (stage) {
+        case messages: return "messages";
+        case subdivision: return "subdivision";
+        case color: return "color";
+        case present: return "present";
+        case latency: return "latency";
+        default: return "unknown";
+    }
+}
+
+const char *Profiler::counter_name(Counter counter) noexcept {
+    switch (counter) {
+        case iterations: return "iterations";
+        case saved_iterations: return "saved_iterations";
+        case filled_cells: return "filled_cells";
+        case cells_drawn: return "cells_drawn";
+        case cache_hits: return "cache_hits";
+        default: return "unknown";
+    }
+}
+
+void Profiler::add_time(Stage stage, std::chrono::steady_clock::duration duration) noexcept {
+    current_.stage_ns[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+void Profiler::add_count(Counter counter, std::uint64_t count) noexcept { current_.counters[counter] += count; }
+
+void Profiler::merge_current(Profiler &other) noexcept {
+    for (int stage = 0; stage < stage_count; stage++) current_.stage_ns[stage] += other.current_.stage_ns[stage];
+    for (int counter = 0; counter < counter_count; counter++)
+        current_.counters[counter] += other.current_.counters[counter];
+    other.current_ = Frame();
+}
+
+void Profiler::end_frame() {
+    frames_.push_back(current_);
+    if (frames_.size() > max_frames_) frames_.pop_front();
+    current_ = Frame();
+}
+
+void Profiler::clear() noexcept { frames_.clear(); }
+
+Profiler::Summary Profiler::summarize(Stage stage) const {
+    std::vector<std::int64_t> values;
+    values.reserve(frames_.size());
+    for (const Frame &frame : frames_) values.push_back(frame.stage_ns[stage]);
+    return summarize_(std::move(values), 1e-6);
+}
+
+Profiler::Summary Profiler::summarize(Counter counter) const {
+    std::vector<std::uint64_t> values;
+    values.reserve(frames_.size());
+    for (const Frame &frame : frames_) values.push_back(frame.counters[counter]);
+    return summarize_(std::move(values), 1.0);
+}
+
+template <typename Value>
+Profiler::Summary Profiler::summarize_(std::vector<Value> values, double scale) {
+    Summary summary;
+    if (values.empty()) return summary;
+
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (const Value value : values) sum += static_cast<double>(value);
+
+    const std::size_t p95_rank = (values.size() * 95 + 99) / 100 - 1;
+    summary.min = values.front() * scale;
+    summary.mean = sum / values.size() * scale;
+    summary.p95 = values[p95_rank] * scale;
+    return summary;
+}
@@ -0,0 +1,77 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Collects the duration of every frame stage and a few work counters, one sample per frame,
+// and summarizes the frames recorded since the last clear() as min/mean/p95.
+class Profiler {
+   public:
+    // latency is the age of the image on screen: from the moment its c was taken to the end of the present
+    enum Stage { messages, subdivision, color, present, latency, stage_count };
+    enum Counter { iterations, saved_iterations, filled_cells, cells_drawn, cache_hits, counter_count };
+
+    struct Summary {
+        double min = 0.0;
+        double mean = 0.0;
+        double p95 = 0.0;
+    };
+
+    // Adds the time from construction to destruction to a stage, or does nothing without a profiler
+    class Scope {
+       public:
+        Scope(Profiler *profiler, Stage stage) noexcept : profiler_(profiler), stage_(stage) {
+            if (profiler_) start_ = std::chrono::steady_clock::now();
+        }
+        ~Scope() {
+            if (profiler_) profiler_->add_time(stage_, std::chrono::steady_clock::now() - start_);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+       private:
+        Profiler *profiler_;
+        Stage stage_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    static const char *stage_name(Stage stage) noexcept;
+    static const char *counter_name(Counter counter) noexcept;
+
+    void add_time(Stage stage, std::chrono::steady_clock::duration duration) noexcept;
+    void add_count(Counter counter, std::uint64_t count) noexcept;
+
+    // Adds the times and counts of other's current frame to this one and resets other's, for a profiler that
+    // another thread fills while this one is in use
+    void merge_current(Profiler &other) noexcept;
+    // Closes the current frame; stages and counters that were not touched in it count as 0
+    void end_frame();
+    void clear() noexcept;
+
+    std::size_t get_frame_count() const noexcept { return frames_.size(); }
+    // stage durations are summarized in milliseconds
+    Summary summarize(Stage stage) const;
+    Summary summarize(Counter counter) const;
+
+   private:
+    struct Frame {
+        std::array<std::int64_t, stage_count> stage_ns{};
+        std::array<std::uint64_t, counter_count> counters{};
+    };
+
+    Frame current_;
+    std::deque<Frame> frames_;
+    std::size_t max_frames_ = 600;
+
+    template <typename Value>
+    static Summary summarize_(std::vector<Value> values, double scale);
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "QualityController.hpp"
+
+void QualityController::set_target_frame_time(const double &milliseconds) noexcept {
+    target_frame_time_ = std::max(1.0, milliseconds);
+    frames_since_change_ = 0;
+}
+
+void QualityController::set_bounds(const Bounds &bounds) noexcept {
+    bounds_ = bounds;
+    bounds_.min_resolution = std::max(8, bounds_.min_resolution / 2 * 2);
+    bounds_.max_resolution = std::max(bounds_.min_resolution, bounds_.max_resolution / 2 * 2);
+    bounds_.min_max_iterations = std::max(2, bounds_.min_max_iterations);
+    bounds_.max_max_iterations = std::max(bounds_.min_max_iterations, bounds_.max_max_iterations);
+    clamp_();
+}
+
+const QualityController::Quality &QualityController::update(const double &frame_time, const bool &paused) noexcept {
+    if (!enabled_) return quality_;
+
+    smoothed_frame_time_ =
+        smoothed_frame_time_ ? smoothed_frame_time_ + (frame_time - smoothed_frame_time_) * smoothing_ : frame_time;
+    frames_since_change_++;
+
+    if (paused) {
+        if (raise_()) frames_since_change_ = 0;
+        return quality_;
+    }
+    if (frames_since_change_ < settle_frames_) return quality_;
+
+    bool changed = false;
+    if (smoothed_frame_time_ > target_frame_time_ * (1 + slower_band_))
+        changed = lower_();
+    else if (smoothed_frame_time_ < target_frame_time_ * (1 - faster_band_))
+        changed = raise_();
+    if (changed) frames_since_change_ = 0;
+
+    return quality_;
+}
+
+// The iteration cap goes first since it costs the least detail, the resolution last
+bool QualityController::lower_() noexcept {
+    if (quality_.max_iterations > bounds_.min_max_iterations) {
+        quality_.max_iterations = std::max(bounds_.min_max_iterations, quality_.max_iterations * 3 / 4);
+        return true;
+    }
+    if (quality_.resolution > bounds_.min_resolution) {
+        quality_.resolution = std::max(bounds_.min_resolution, quality_.resolution * 7 / 8 / 2 * 2);
+        return true;
+    }
+    return false;
+}
+
+// Undoes lower_ in reverse order
+bool QualityController::raise_() noexcept {
+    if (quality_.resolution < bounds_.max_resolution) {
+        quality_.resolution = std::min(bounds_.max_resolution, (quality_.resolution * 8 / 7 + 1) / 2 * 2);
+        return true;
+    }
+    if (quality_.max_iterations < bounds_.max_max_iterations) {
+        quality_.max_iterations = std::min(bounds_.max_max_iterations, quality_.max_iterations * 4 / 3 + 1);
+        return true;
+    }
+    return false;
+}
+
+void QualityController::clamp_() noexcept {
+    quality_.resolution = std::clamp(quality_.resolution, bounds_.min_resolution, bounds_.max_resolution);
+    quality_.max_iterations =
+        std::clamp(quality_.max_iterations, bounds_.min_max_iterations, bounds_.max_max_iterations);
+}
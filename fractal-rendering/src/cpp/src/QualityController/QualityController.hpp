@@ -0,0 +1,57 @@
+#ifndef QUALITY_CONTROLLER_HPP
+#define QUALITY_CONTROLLER_HPP
+
+#include <algorithm>
+
+// Picks the render quality for the next frame from the measured cost of the previous ones.
+// The frame time is smoothed, and quality only changes when it leaves a band around the target and a few frames
+// have passed since the last change, so the controller settles instead of oscillating.
+// While the animation is paused, quality is raised one notch per frame until the upper bounds are reached.
+class QualityController {
+   public:
+    struct Quality {
+        int resolution = 600;
+        int max_iterations = 50;
+
+        bool operator==(const Quality &other) const noexcept = default;
+    };
+
+    // Inclusive
+    struct Bounds {
+        int min_resolution = 240;
+        int max_resolution = 600;
+        int min_max_iterations = 30;
+        int max_max_iterations = 100;
+    };
+
+    void set_enabled(const bool &enabled) noexcept { enabled_ = enabled; }
+    bool is_enabled() const noexcept { return enabled_; }
+    void set_target_frame_time(const double &milliseconds) noexcept;
+    double get_target_frame_time() const noexcept { return target_frame_time_; }
+    void set_bounds(const Bounds &bounds) noexcept;
+    const Bounds &get_bounds() const noexcept { return bounds_; }
+
+    // Feeds the time the last frame took to compute and present, and returns the quality for the next one
+    const Quality &update(const double &frame_time, const bool &paused) noexcept;
+    const Quality &get_quality() const noexcept { return quality_; }
+
+   private:
+    bool enabled_ = true;
+    double target_frame_time_ = 16.6;
+    Bounds bounds_;
+    Quality quality_;
+
+    double smoothed_frame_time_ = 0.0;
+    double smoothing_ = 0.1;
+    // quality drops above target * (1 + slower_band_) and rises below target * (1 - faster_band_)
+    double slower_band_ = 0.1;
+    double faster_band_ = 0.3;
+    int settle_frames_ = 30;
+    int frames_since_change_ = 0;
+
+    bool lower_() noexcept;
+    bool raise_() noexcept;
+    void clamp_() noexcept;
+};
+
+#endif
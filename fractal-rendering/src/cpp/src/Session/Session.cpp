@@ -0,0 +1,191 @@
+#include "Session.hpp"
+
+Session::Session(SDL_Renderer* renderer) : sketch_(std::make_unique<Sketch>(renderer)) {
+    sketch_->set_profiler(&profiler_);
+    quality_ = quality_controller_.get_quality();
+    sketch_->set_quality(quality_.resolution, quality_.max_iterations);
+}
+
+void Session::resize(const int& width, const int& height) {
+    if (trace_) trace_->resize(width, height);
+    window_width_ = width;
+    window_height_ = height;
+    sketch_->set_window_size(width, height);
+}
+
+void Session::zoom_at(const int& window_x, const int& window_y, const int& notches) {
+    if (trace_) trace_->wheel(window_x, window_y, notches);
+    sketch_->zoom_at(window_x, window_y, std::pow(zoom_per_wheel_step_, notches));
+}
+
+void Session::pan(const int& window_dx, const int& window_dy) {
+    if (trace_) trace_->drag(window_dx, window_dy);
+    sketch_->pan(window_dx, window_dy);
+}
+
+// The delta time is capped by vsync, so the quality is driven by how long the frame itself took. A pipelined frame is
+// rendered next to the loop, so the render time bounds it instead. While c stands still, the quality is raised one
+// frame at a time up to its bounds.
+bool Session::tick(const double& delta_time) {
+    if (trace_) trace_->tick(delta_time);
+
+    // Frames are only rendered and presented when something on screen changes
+    sketch_->advance(delta_time);
+    if (!sketch_->needs_frame()) return false;
+
+    const auto frame_start = std::chrono::steady_clock::now();
+    sketch_->update();
+    sketch_->draw();
+    frame_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+    profiler_.end_frame();
+
+    const double frame_ms = sketch_->is_pipelined() ? std::max(frame_ms_, sketch_->get_render_ms()) : frame_ms_;
+    quality_controller_.update(frame_ms, !sketch_->is_animating());
+    apply_quality_();
+    return true;
+}
+
+void Session::apply_command(const Command& command) {
+    if (trace_) trace_->command(command);
+
+    const double* args = command.args;
+    switch (command.type) {
+        case Command::threads:
+            // The browser starts a fixed pool of one worker per core, and workers past it would never start
+            if (args[0] >= 1)
+                sketch_->set_thread_count(
+                    std::min(static_cast<std::size_t>(args[0]), WorkerPool::default_thread_count()));
+            break;
+        case Command::paused:
+            sketch_->set_paused(args[0] != 0.0);
+            break;
+        case Command::seek:
+            sketch_->seek(static_cast<float>(args[0]));
+            break;
+        case Command::playback_rate:
+            sketch_->set_playback_rate(static_cast<float>(args[0]));
+            break;
+        case Command::loop_range:
+            sketch_->set_loop_range(static_cast<float>(args[0]), static_cast<float>(args[1]));
+            break;
+        case Command::set_c:
+            sketch_->set_c(static_cast<float>(args[0]), static_cast<float>(args[1]));
+            break;
+        case Command::animate_c:
+            sketch_->animate_c();
+            break;
+        case Command::view: {
+            FractalRenderer::View view;
+            view.center_x = DoubleDouble(args[0], args[1]);
+            view.center_y = DoubleDouble(args[2], args[3]);
+            view.half_height = args[4];
+            if (view.half_height > 0.0) sketch_->set_view(view);
+            break;
+        }
+        case Command::reset_view:
+            sketch_->reset_view();
+            break;
+        case Command::quality:
+            set_quality_(command);
+            break;
+        case Command::palette_stop:
+            if (pending_palette_.size() < max_palette_stops_)
+                pending_palette_.push_back(
+                    {static_cast<float>(args[0]), to_channel_(args[1]), to_channel_(args[2]), to_channel_(args[3])});
+            break;
+        case Command::palette_commit:
+            if (!pending_palette_.empty()) sketch_->set_palette(pending_palette_);
+            pending_palette_.clear();
+            break;
+        case Command::palette_default:
+            pending_palette_.clear();
+            sketch_->reset_palette();
+            break;
+        case Command::formula:
+            if (args[0] >= 0 && args[0] < static_cast<double>(FractalRenderer::formula_count))
+                sketch_->set_formula(static_cast<FractalRenderer::Formula>(static_cast<int>(args[0])));
+            break;
+        case Command::frame_cache:
+            sketch_->set_frame_cache(args[0] != 0.0,
+                                     args[1] < 0 ? sketch_->get_frame_cache().get_budget()
+                                                 : static_cast<std::size_t>(
+                                                       std::min(args[1], max_frame_cache_budget_) * (1 << 20)));
+            break;
+        case Command::pipelined:
+            sketch_->set_pipelined(args[0] != 0.0);
+            break;
+    }
+}
+
+// Negative arguments keep the current setting
+void Session::set_quality_(const Command& command) {
+    const double* args = command.args;
+
+    const auto read_range = [&](int index, int& min, int& max) {
+        if (args[index] >= 0) min = static_cast<int>(args[index]);
+        if (args[index + 1] >= 0) max = static_cast<int>(args[index + 1]);
+    };
+
+    QualityController::Bounds bounds = quality_controller_.get_bounds();
+    read_range(2, bounds.min_resolution, bounds.max_resolution);
+    read_range(4, bounds.min_max_iterations, bounds.max_max_iterations);
+    quality_controller_.set_bounds(bounds);
+
+    if (args[1] >= 0) quality_controller_.set_target_frame_time(args[1]);
+    if (args[0] >= 0) quality_controller_.set_enabled(args[0] != 0.0);
+
+    apply_quality_();
+}
+
+void Session::set_fixed_quality(const int& resolution, const int& max_iterations) {
+    fixed_quality_ = true;
+    quality_ = {resolution, max_iterations};
+    sketch_->set_quality(resolution, max_iterations);
+}
+
+// Only quality changes are recorded, right after the tick or command that caused them
+void Session::apply_quality_() {
+    if (fixed_quality_) return;
+
+    const QualityController::Quality& quality = quality_controller_.get_quality();
+    if (trace_ && quality != quality_) trace_->quality(quality.resolution, quality.max_iterations);
+    quality_ = quality;
+    sketch_->set_quality(quality_.resolution, quality_.max_iterations);
+}
+
+void Session::set_trace(TraceWriter* trace) {
+    trace_ = trace;
+    if (trace_) record_state_();
+}
+
+// Records the window, the quality and the commands that take a new sketch to the current one; c is set last, since
+// seek returns it to the animation
+void Session::record_state_() {
+    trace_->resize(window_width_, window_height_);
+    trace_->quality(quality_.resolution, quality_.max_iterations);
+
+    const auto record = [&](const Command::Type& type, std::initializer_list<double> args) {
+        Command command;
+        command.type = type;
+        std::copy(args.begin(), args.end(), command.args);
+        trace_->command(command);
+    };
+
+    const Sketch& sketch = *sketch_;
+    const FractalRenderer::View& view = sketch.get_view();
+    record(Command::threads, {static_cast<double>(sketch.get_thread_count())});
+    record(Command::formula, {static_cast<double>(sketch.get_formula())});
+    record(Command::view, {view.center_x.hi, view.center_x.lo, view.center_y.hi, view.center_y.lo, view.half_height});
+    record(Command::frame_cache, {static_cast<double>(sketch.is_frame_cache_enabled()),
+                                  static_cast<double>(sketch.get_frame_cache().get_budget()) / (1 << 20)});
+    record(Command::pipelined, {static_cast<double>(sketch.is_pipelined())});
+    record(Command::paused, {static_cast<double>(sketch.is_paused())});
+    record(Command::playback_rate, {sketch.get_playback_rate()});
+    record(Command::loop_range, {sketch.get_loop_start(), sketch.get_loop_end()});
+    record(Command::seek, {sketch.get_progress()});
+    if (sketch.is_c_pinned()) record(Command::set_c, {sketch.get_c_real(), sketch.get_c_imag()});
+}
+
+std::uint8_t Session::to_channel_(const double& value) noexcept {
+    return static_cast<std::uint8_t>(std::clamp(value, 0.0, 255.0));
+}
@@ -0,0 +1,81 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "../Profiler/Profiler.hpp"
+#include "../QualityController/QualityController.hpp"
+#include "../Sketch/Sketch.hpp"
+#include "../Trace/Trace.hpp"
+#include "../messaging/CommandQueue.hpp"
+
+// Everything behind the app window: the sketch, the quality it renders at, and the inputs that drive them. The app
+// feeds it window events, page commands and the time between loop wakeups; fractal_replay feeds it the same inputs
+// from a trace, so a replay runs the code the app ran.
+class Session {
+   public:
+    // renderer is null in headless builds
+    explicit Session(SDL_Renderer *renderer);
+
+    void resize(const int &width, const int &height);
+    // Zooms at a window position by mouse wheel notches, up zooming in
+    void zoom_at(const int &window_x, const int &window_y, const int &notches);
+    void pan(const int &window_dx, const int &window_dy);
+    void apply_command(const Command &command);
+    // Moves the animation by delta_time ms, then renders and draws a frame if one is needed; returns whether it did
+    bool tick(const double &delta_time);
+    // Nothing will be drawn until the next input
+    bool is_idle() const noexcept { return !sketch_->needs_frame() && !sketch_->is_animating(); }
+
+    // Appends every following input to trace, after the state the sketch is in now; null stops recording. The
+    // palette only changes colors, so it is left out of that state.
+    void set_trace(TraceWriter *trace);
+    // Renders at a quality a trace recorded instead of adapting it to the frame time, so a replay renders the same
+    // frames however fast it runs
+    void set_fixed_quality(const int &resolution, const int &max_iterations);
+
+    Sketch &get_sketch() noexcept { return *sketch_; }
+    const Sketch &get_sketch() const noexcept { return *sketch_; }
+    Profiler &get_profiler() noexcept { return profiler_; }
+    const QualityController::Quality &get_quality() const noexcept { return quality_; }
+    // update and draw time of the last frame, ms
+    double get_frame_ms() const noexcept { return frame_ms_; }
+
+   private:
+    Profiler profiler_;
+    QualityController quality_controller_;
+    std::unique_ptr<Sketch> sketch_;
+
+    // quality the sketch renders at, from the controller unless fixed_quality_
+    QualityController::Quality quality_;
+    bool fixed_quality_ = false;
+
+    int window_width_ = 0;
+    int window_height_ = 0;
+    double frame_ms_ = 0.0;
+
+    TraceWriter *trace_ = nullptr;
+
+    // view height multiplier per mouse wheel notch, wheeling up zooms in
+    double zoom_per_wheel_step_ = 0.8;
+
+    // stops of a palette being sent, applied together by palette_commit
+    std::vector<Palette::Stop> pending_palette_;
+    std::size_t max_palette_stops_ = 64;
+
+    // largest frame cache budget a command can ask for, MiB
+    double max_frame_cache_budget_ = 1024.0;
+
+    void set_quality_(const Command &command);
+    void apply_quality_();
+    void record_state_();
+    static std::uint8_t to_channel_(const double &value) noexcept;
+};
+
+#endif
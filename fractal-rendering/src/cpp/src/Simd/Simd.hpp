@@ -0,0 +1,190 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+// The kernels are written against the wasm_simd128.h intrinsics.
+// Outside of WebAssembly the subset they use is provided here on top of SSE2, or plain scalar code elsewhere,
+// so native builds run the very same kernels.
+
+#if defined(__wasm_simd128__)
+
+#include <wasm_simd128.h>
+
+inline constexpr const char *simd_backend = "wasm simd128";
+
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <emmintrin.h>
+
+inline constexpr const char *simd_backend = "sse2";
+
+typedef __m128i v128_t;
+
+inline v128_t wasm_v128_load(const void *mem) { return _mm_loadu_si128(static_cast<const __m128i *>(mem)); }
+inline void wasm_v128_store(void *mem, v128_t a) { _mm_storeu_si128(static_cast<__m128i *>(mem), a); }
+
+inline v128_t wasm_v128_and(v128_t a, v128_t b) { return _mm_and_si128(a, b); }
+inline v128_t wasm_v128_or(v128_t a, v128_t b) { return _mm_or_si128(a, b); }
+inline v128_t wasm_v128_andnot(v128_t a, v128_t b) { return _mm_andnot_si128(b, a); }
+inline v128_t wasm_v128_bitselect(v128_t a, v128_t b, v128_t mask) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+inline bool wasm_v128_any_true(v128_t a) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128())) != 0xFFFF;
+}
+
+inline v128_t wasm_i32x4_splat(int a) { return _mm_set1_epi32(a); }
+inline v128_t wasm_i32x4_add(v128_t a, v128_t b) { return _mm_add_epi32(a, b); }
+inline v128_t wasm_i32x4_eq(v128_t a, v128_t b) { return _mm_cmpeq_epi32(a, b); }
+inline v128_t wasm_i32x4_lt(v128_t a, v128_t b) { return _mm_cmplt_epi32(a, b); }
+inline int wasm_i32x4_extract_lane(v128_t a, int lane) {
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), a);
+    return lanes[lane];
+}
+// Unlike the wasm instruction this does not saturate; out of range lanes become INT32_MIN
+inline v128_t wasm_i32x4_trunc_sat_f32x4(v128_t a) { return _mm_cvttps_epi32(_mm_castsi128_ps(a)); }
+
+inline v128_t wasm_f32x4_splat(float a) { return _mm_castps_si128(_mm_set1_ps(a)); }
+inline v128_t wasm_f32x4_make(float a, float b, float c, float d) { return _mm_castps_si128(_mm_setr_ps(a, b, c, d)); }
+inline v128_t wasm_f32x4_convert_i32x4(v128_t a) { return _mm_castps_si128(_mm_cvtepi32_ps(a)); }
+
+#define FLOW_SIMD_F32X4_BINARY(name, instruction)                                          \
+    inline v128_t name(v128_t a, v128_t b) {                                               \
+        return _mm_castps_si128(instruction(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); \
+    }
+
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_add, _mm_add_ps)
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_sub, _mm_sub_ps)
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_mul, _mm_mul_ps)
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_div, _mm_div_ps)
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_max, _mm_max_ps)
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_gt, _mm_cmpgt_ps)
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_lt, _mm_cmplt_ps)
+FLOW_SIMD_F32X4_BINARY(wasm_f32x4_le, _mm_cmple_ps)
+
+#undef FLOW_SIMD_F32X4_BINARY
+
+inline v128_t wasm_f32x4_sqrt(v128_t a) { return _mm_castps_si128(_mm_sqrt_ps(_mm_castsi128_ps(a))); }
+
+#else
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+inline constexpr const char *simd_backend = "scalar";
+
+struct v128_t {
+    std::int32_t i[4];
+};
+
+namespace simd_detail {
+
+inline float f32(const v128_t &a, int lane) {
+    float value;
+    std::memcpy(&value, &a.i[lane], sizeof(value));
+    return value;
+}
+
+template <typename F>
+inline v128_t map_f32(F f) {
+    v128_t result;
+    for (int lane = 0; lane < 4; lane++) {
+        const float value = f(lane);
+        std::memcpy(&result.i[lane], &value, sizeof(value));
+    }
+    return result;
+}
+
+template <typename F>
+inline v128_t map_i32(F f) {
+    v128_t result;
+    for (int lane = 0; lane < 4; lane++) result.i[lane] = f(lane);
+    return result;
+}
+
+}  // namespace simd_detail
+
+inline v128_t wasm_v128_load(const void *mem) {
+    v128_t result;
+    std::memcpy(&result, mem, sizeof(result));
+    return result;
+}
+inline void wasm_v128_store(void *mem, v128_t a) { std::memcpy(mem, &a, sizeof(a)); }
+
+inline v128_t wasm_v128_and(v128_t a, v128_t b) {
+    return simd_detail::map_i32([&](int lane) { return a.i[lane] & b.i[lane]; });
+}
+inline v128_t wasm_v128_or(v128_t a, v128_t b) {
+    return simd_detail::map_i32([&](int lane) { return a.i[lane] | b.i[lane]; });
+}
+inline v128_t wasm_v128_andnot(v128_t a, v128_t b) {
+    return simd_detail::map_i32([&](int lane) { return a.i[lane] & ~b.i[lane]; });
+}
+inline v128_t wasm_v128_bitselect(v128_t a, v128_t b, v128_t mask) {
+    return simd_detail::map_i32([&](int lane) { return (a.i[lane] & mask.i[lane]) | (b.i[lane] & ~mask.i[lane]); });
+}
+inline bool wasm_v128_any_true(v128_t a) { return a.i[0] | a.i[1] | a.i[2] | a.i[3]; }
+
+inline v128_t wasm_i32x4_splat(int a) {
+    return simd_detail::map_i32([&](int) { return a; });
+}
+inline v128_t wasm_i32x4_add(v128_t a, v128_t b) {
+    return simd_detail::map_i32([&](int lane) { return a.i[lane] + b.i[lane]; });
+}
+inline v128_t wasm_i32x4_eq(v128_t a, v128_t b) {
+    return simd_detail::map_i32([&](int lane) { return a.i[lane] == b.i[lane] ? -1 : 0; });
+}
+inline v128_t wasm_i32x4_lt(v128_t a, v128_t b) {
+    return simd_detail::map_i32([&](int lane) { return a.i[lane] < b.i[lane] ? -1 : 0; });
+}
+inline int wasm_i32x4_extract_lane(v128_t a, int lane) { return a.i[lane]; }
+inline v128_t wasm_i32x4_trunc_sat_f32x4(v128_t a) {
+    return simd_detail::map_i32([&](int lane) { return static_cast<std::int32_t>(simd_detail::f32(a, lane)); });
+}
+
+inline v128_t wasm_f32x4_splat(float a) {
+    return simd_detail::map_f32([&](int) { return a; });
+}
+inline v128_t wasm_f32x4_make(float a, float b, float c, float d) {
+    const float values[4] = {a, b, c, d};
+    return simd_detail::map_f32([&](int lane) { return values[lane]; });
+}
+inline v128_t wasm_f32x4_convert_i32x4(v128_t a) {
+    return simd_detail::map_f32([&](int lane) { return static_cast<float>(a.i[lane]); });
+}
+inline v128_t wasm_f32x4_add(v128_t a, v128_t b) {
+    return simd_detail::map_f32([&](int lane) { return simd_detail::f32(a, lane) + simd_detail::f32(b, lane); });
+}
+inline v128_t wasm_f32x4_sub(v128_t a, v128_t b) {
+    return simd_detail::map_f32([&](int lane) { return simd_detail::f32(a, lane) - simd_detail::f32(b, lane); });
+}
+inline v128_t wasm_f32x4_mul(v128_t a, v128_t b) {
+    return simd_detail::map_f32([&](int lane) { return simd_detail::f32(a, lane) * simd_detail::f32(b, lane); });
+}
+inline v128_t wasm_f32x4_div(v128_t a, v128_t b) {
+    return simd_detail::map_f32([&](int lane) { return simd_detail::f32(a, lane) / simd_detail::f32(b, lane); });
+}
+inline v128_t wasm_f32x4_max(v128_t a, v128_t b) {
+    return simd_detail::map_f32(
+        [&](int lane) { return std::fmax(simd_detail::f32(a, lane), simd_detail::f32(b, lane)); });
+}
+inline v128_t wasm_f32x4_sqrt(v128_t a) {
+    return simd_detail::map_f32([&](int lane) { return std::sqrt(simd_detail::f32(a, lane)); });
+}
+inline v128_t wasm_f32x4_gt(v128_t a, v128_t b) {
+    return simd_detail::map_i32(
+        [&](int lane) { return simd_detail::f32(a, lane) > simd_detail::f32(b, lane) ? -1 : 0; });
+}
+inline v128_t wasm_f32x4_lt(v128_t a, v128_t b) {
+    return simd_detail::map_i32(
+        [&](int lane) { return simd_detail::f32(a, lane) < simd_detail::f32(b, lane) ? -1 : 0; });
+}
+inline v128_t wasm_f32x4_le(v128_t a, v128_t b) {
+    return simd_detail::map_i32(
+        [&](int lane) { return simd_detail::f32(a, lane) <= simd_detail::f32(b, lane) ? -1 : 0; });
+}
+
+#endif
+
+#endif
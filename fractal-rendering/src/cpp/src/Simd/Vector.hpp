@@ -0,0 +1,61 @@
+#ifndef VECTOR_HPP
+#define VECTOR_HPP
+
+#include <cstdint>
+
+#include "Simd.hpp"
+
+// The escape-time kernel (see EscapeKernel.hpp) is written once against a vector type V and instantiated for every
+// width. Each vector type is a struct of static functions with the same names:
+//   F, I, Mask      float lanes, int32 lanes and a lane mask
+//   load, store     unaligned memory access to lanes floats (store_i for int32 lanes)
+//   splat, splat_i  a value in every lane
+//   add, sub, mul, div, max, sqrt, abs, convert    lane-wise float arithmetic, convert from int32
+//   lt, gt, le, eq_i                               comparisons into a Mask
+//   all, mask_or, mask_and, mask_andnot, any       mask algebra; mask_andnot(a, b) is a and not b
+//   select, select_i                               per lane, the first value where the mask is set
+//   bits, from_bits, and_i, or_i                   reinterpretation between F and I and bitwise logic
+// Results are bit-identical across widths, since every operation is an IEEE operation on a single lane.
+
+// Four lanes of the wasm_simd128.h subset of Simd.hpp: wasm SIMD in the browser, SSE2 or scalar natively
+struct Vector4 {
+    static constexpr int lanes = 4;
+    using F = v128_t;
+    using I = v128_t;
+    using Mask = v128_t;
+
+    static F load(const float *p) noexcept { return wasm_v128_load(p); }
+    static void store(float *p, const F &a) noexcept { wasm_v128_store(p, a); }
+    static void store_i(std::int32_t *p, const I &a) noexcept { wasm_v128_store(p, a); }
+    static F splat(float a) noexcept { return wasm_f32x4_splat(a); }
+    static I splat_i(int a) noexcept { return wasm_i32x4_splat(a); }
+
+    static F add(const F &a, const F &b) noexcept { return wasm_f32x4_add(a, b); }
+    static F sub(const F &a, const F &b) noexcept { return wasm_f32x4_sub(a, b); }
+    static F mul(const F &a, const F &b) noexcept { return wasm_f32x4_mul(a, b); }
+    static F div(const F &a, const F &b) noexcept { return wasm_f32x4_div(a, b); }
+    static F max(const F &a, const F &b) noexcept { return wasm_f32x4_max(a, b); }
+    static F sqrt(const F &a) noexcept { return wasm_f32x4_sqrt(a); }
+    static F abs(const F &a) noexcept { return wasm_v128_andnot(a, wasm_f32x4_splat(-0.0f)); }
+    static F convert(const I &a) noexcept { return wasm_f32x4_convert_i32x4(a); }
+
+    static Mask lt(const F &a, const F &b) noexcept { return wasm_f32x4_lt(a, b); }
+    static Mask gt(const F &a, const F &b) noexcept { return wasm_f32x4_gt(a, b); }
+    static Mask le(const F &a, const F &b) noexcept { return wasm_f32x4_le(a, b); }
+    static Mask eq_i(const I &a, const I &b) noexcept { return wasm_i32x4_eq(a, b); }
+
+    static Mask all() noexcept { return wasm_i32x4_splat(-1); }
+    static Mask mask_or(const Mask &a, const Mask &b) noexcept { return wasm_v128_or(a, b); }
+    static Mask mask_and(const Mask &a, const Mask &b) noexcept { return wasm_v128_and(a, b); }
+    static Mask mask_andnot(const Mask &a, const Mask &b) noexcept { return wasm_v128_andnot(a, b); }
+    static bool any(const Mask &a) noexcept { return wasm_v128_any_true(a); }
+    static F select(const Mask &mask, const F &a, const F &b) noexcept { return wasm_v128_bitselect(a, b, mask); }
+    static I select_i(const Mask &mask, const I &a, const I &b) noexcept { return wasm_v128_bitselect(a, b, mask); }
+
+    static I bits(const F &a) noexcept { return a; }
+    static F from_bits(const I &a) noexcept { return a; }
+    static I and_i(const I &a, const I &b) noexcept { return wasm_v128_and(a, b); }
+    static I or_i(const I &a, const I &b) noexcept { return wasm_v128_or(a, b); }
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef VECTOR_AVX2_HPP
+#define VECTOR_AVX2_HPP
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+// Eight lanes of AVX2, with the interface described in Vector.hpp.
+// Only included by translation units built with -mavx2, which run once the CPU is known to support it.
+struct Vector8 {
+    static constexpr int lanes = 8;
+    using F = __m256;
+    using I = __m256i;
+    using Mask = __m256;
+
+    static F load(const float *p) noexcept { return _mm256_loadu_ps(p); }
+    static void store(float *p, const F &a) noexcept { _mm256_storeu_ps(p, a); }
+    static void store_i(std::int32_t *p, const I &a) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+    }
+    static F splat(float a) noexcept { return _mm256_set1_ps(a); }
+    static I splat_i(int a) noexcept { return _mm256_set1_epi32(a); }
+
+    static F add(const F &a, const F &b) noexcept { return _mm256_add_ps(a, b); }
+    static F sub(const F &a, const F &b) noexcept { return _mm256_sub_ps(a, b); }
+    static F mul(const F &a, const F &b) noexcept { return _mm256_mul_ps(a, b); }
+    static F div(const F &a, const F &b) noexcept { return _mm256_div_ps(a, b); }
+    static F max(const F &a, const F &b) noexcept { return _mm256_max_ps(a, b); }
+    static F sqrt(const F &a) noexcept { return _mm256_sqrt_ps(a); }
+    static F abs(const F &a) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static F convert(const I &a) noexcept { return _mm256_cvtepi32_ps(a); }
+
+    static Mask lt(const F &a, const F &b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Mask gt(const F &a, const F &b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Mask le(const F &a, const F &b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static Mask eq_i(const I &a, const I &b) noexcept { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+
+    static Mask all() noexcept { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static Mask mask_or(const Mask &a, const Mask &b) noexcept { return _mm256_or_ps(a, b); }
+    static Mask mask_and(const Mask &a, const Mask &b) noexcept { return _mm256_and_ps(a, b); }
+    static Mask mask_andnot(const Mask &a, const Mask &b) noexcept { return _mm256_andnot_ps(b, a); }
+    static bool any(const Mask &a) noexcept { return _mm256_movemask_ps(a) != 0; }
+    static F select(const Mask &mask, const F &a, const F &b) noexcept { return _mm256_blendv_ps(b, a, mask); }
+    static I select_i(const Mask &mask, const I &a, const I &b) noexcept {
+        return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), mask));
+    }
+
+    static I bits(const F &a) noexcept { return _mm256_castps_si256(a); }
+    static F from_bits(const I &a) noexcept { return _mm256_castsi256_ps(a); }
+    static I and_i(const I &a, const I &b) noexcept { return _mm256_and_si256(a, b); }
+    static I or_i(const I &a, const I &b) noexcept { return _mm256_or_si256(a, b); }
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef VECTOR_AVX512_HPP
+#define VECTOR_AVX512_HPP
+
+#include <immintrin.h>
+
+#include <cstdint>
+
+// Sixteen lanes of AVX-512F, with the interface described in Vector.hpp; masks live in mask registers.
+// Only included by translation units built with -mavx512f, which run once the CPU is known to support it.
+struct Vector16 {
+    static constexpr int lanes = 16;
+    using F = __m512;
+    using I = __m512i;
+    using Mask = __mmask16;
+
+    static F load(const float *p) noexcept { return _mm512_loadu_ps(p); }
+    static void store(float *p, const F &a) noexcept { _mm512_storeu_ps(p, a); }
+    static void store_i(std::int32_t *p, const I &a) noexcept { _mm512_storeu_si512(p, a); }
+    static F splat(float a) noexcept { return _mm512_set1_ps(a); }
+    static I splat_i(int a) noexcept { return _mm512_set1_epi32(a); }
+
+    static F add(const F &a, const F &b) noexcept { return _mm512_add_ps(a, b); }
+    static F sub(const F &a, const F &b) noexcept { return _mm512_sub_ps(a, b); }
+    static F mul(const F &a, const F &b) noexcept { return _mm512_mul_ps(a, b); }
+    static F div(const F &a, const F &b) noexcept { return _mm512_div_ps(a, b); }
+    static F max(const F &a, const F &b) noexcept { return _mm512_max_ps(a, b); }
+    static F sqrt(const F &a) noexcept { return _mm512_sqrt_ps(a); }
+    static F abs(const F &a) noexcept { return _mm512_abs_ps(a); }
+    static F convert(const I &a) noexcept { return _mm512_cvtepi32_ps(a); }
+
+    static Mask lt(const F &a, const F &b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static Mask gt(const F &a, const F &b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static Mask le(const F &a, const F &b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static Mask eq_i(const I &a, const I &b) noexcept { return _mm512_cmpeq_epi32_mask(a, b); }
+
+    static Mask all() noexcept { return 0xFFFF; }
+    static Mask mask_or(const Mask &a, const Mask &b) noexcept { return a | b; }
+    static Mask mask_and(const Mask &a, const Mask &b) noexcept { return a & b; }
+    static Mask mask_andnot(const Mask &a, const Mask &b) noexcept { return a & ~b; }
+    static bool any(const Mask &a) noexcept { return a != 0; }
+    static F select(const Mask &mask, const F &a, const F &b) noexcept { return _mm512_mask_blend_ps(mask, b, a); }
+    static I select_i(const Mask &mask, const I &a, const I &b) noexcept {
+        return _mm512_mask_blend_epi32(mask, b, a);
+    }
+
+    static I bits(const F &a) noexcept { return _mm512_castps_si512(a); }
+    static F from_bits(const I &a) noexcept { return _mm512_castsi512_ps(a); }
+    static I and_i(const I &a, const I &b) noexcept { return _mm512_and_si512(a, b); }
+    static I or_i(const I &a, const I &b) noexcept { return _mm512_or_si512(a, b); }
+};
+
+#endif
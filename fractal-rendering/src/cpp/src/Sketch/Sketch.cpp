@@ -2,262 +2,412 @@
 
 Sketch::Sketch(SDL_Renderer* renderer) : renderer_(renderer) { setup(); }
 
+Sketch::~Sketch() {
+    set_pipelined(false);
+#if !FLOW_HEADLESS
+    if (texture_) SDL_DestroyTexture(texture_);
+#endif
+}
+
 void Sketch::setup() {
+    wait_for_compute_();
     cell_width_ = std::max(1, std::min(window_width_, window_height_) / resolution_);
-    grid_height_ = resolution_;
-    grid_width_ = resolution_ / 2;
-    scaled_x_step_ = 2.0f / (grid_width_ - 1) * render_step_width_;
-    scaled_y_step_ = 4.0f / (grid_height_ - 1) * render_step_width_;
-    grid_.resize(grid_height_, std::vector<float>(grid_width_, 0.0f));
+    fractal_.set_resolution(resolution_);
+    grid_height_ = fractal_.grid().height();
+    grid_width_ = fractal_.grid().width();
     canvas_width_ = cell_width_ * grid_height_;
     canvas_center_ = canvas_width_ / 2;
     canvas_offset_x_ = (window_width_ - canvas_width_) / 2;
     canvas_offset_y_ = (window_height_ - canvas_width_) / 2;
+    setup_framebuffer_();
+    dirty_ = true;
 }
 
-void Sketch::update(const double& delta_time) {
-    animation_progress_ += animation_speed_ * delta_time;
-    if (animation_progress_ >= 1.0f) animation_progress_ = 0.0f;
-    calculate_c_();
-    render_grid_();
+void Sketch::advance(const double& delta_time) noexcept {
+    if (is_animating())
+        animation_progress_ =
+            wrap_progress_(animation_progress_ + static_cast<float>(animation_speed_ * playback_rate_ * delta_time));
+    if (c_pinned_) return;
+
+    // with the frame cache, c only moves from slot to slot
+    const float progress =
+        frame_cache_enabled_ ? static_cast<float>(frame_slot_()) / frame_cache_slots_ : animation_progress_;
+    const auto [c_real, c_imag] = c_path_.at(progress);
+    if (c_real == c_real_ && c_imag == c_imag_) return;
+
+    c_real_ = c_real;
+    c_imag_ = c_imag;
+    dirty_ = true;
 }
 
-void Sketch::draw() noexcept {
-    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
-    SDL_RenderClear(renderer_);
-
-    for (int x = 0; x < grid_width_; x++) {
-        for (int y = 0; y < grid_height_; y++) {
-            const float t = grid_[y][x];
-            grid_[y][x] = 0.0f;
-
-            if (t == 0.0f || t == 1.0f) continue;
+void Sketch::update() {
+    const bool cached = frame_cache_enabled_ && !c_pinned_;
+    const FrameCache::Key key{frame_slot_(), grid_width_, grid_height_, get_max_iterations_()};
+    if (pipelined_) return update_pipelined_(key, cached);
+    if (!dirty_) return;
+    dirty_ = false;
+
+    frame_started_at_ = std::chrono::steady_clock::now();
+    showing_cached_grid_ = cached && load_cached_frame_(key);
+    if (showing_cached_grid_) return;
+
+    fractal_.set_c(c_real_, c_imag_);
+    fractal_.render();
+    render_ms_ =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_started_at_).count();
+    if (cached) frame_cache_.store(key, fractal_.grid());
+}
 
-            const auto [r, g, b] = get_color_(t);
-            SDL_SetRenderDrawColor(renderer_, r, g, b, 255);
-            draw_rect_(x, y);
-        }
+// Shows the frame the compute thread finished since the last update, if any, and hands it the next one if there is
+// one and it is not still busy, so the update never waits for a render
+void Sketch::update_pipelined_(const FrameCache::Key& key, const bool& cached) {
+    collect_computed_frame_();
+    if (!dirty_) return;
+
+    if (cached && load_cached_frame_(key)) {
+        showing_cached_grid_ = true;
+        frame_started_at_ = std::chrono::steady_clock::now();
+        dirty_ = false;
+        return;
     }
 
-    SDL_RenderPresent(renderer_);
+    // a frame that changes while one is in flight is requested once that one is collected
+    std::lock_guard<std::mutex> lock(compute_mutex_);
+    if (compute_busy_) return;
+    dirty_ = false;
+
+    apply_pending_settings_();
+    fractal_.set_c(c_real_, c_imag_);
+    compute_key_ = key;
+    compute_cached_ = cached;
+    compute_requested_at_ = std::chrono::steady_clock::now();
+    compute_busy_ = true;
+    compute_requested_.notify_one();
 }
 
-void Sketch::set_window_size(const int& width, const int& height) noexcept {
-    window_width_ = width;
-    window_height_ = height;
-    setup();
+void Sketch::compute_loop_() {
+    std::unique_lock<std::mutex> lock(compute_mutex_);
+    while (true) {
+        compute_requested_.wait(lock, [&] { return compute_stopping_ || (compute_busy_ && !compute_done_); });
+        if (compute_stopping_) return;
+
+        lock.unlock();
+        const auto start = std::chrono::steady_clock::now();
+        fractal_.render();
+        const double render_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        lock.lock();
+
+        render_ms_ = render_ms;
+        compute_done_ = true;
+        compute_finished_.notify_all();
+    }
 }
 
-void Sketch::render_grid_() noexcept {
-    render_sparse_grid();
+// The compute thread is idle between compute_done_ and the next request, so the grids can be swapped
+void Sketch::collect_computed_frame_() {
+    std::lock_guard<std::mutex> lock(compute_mutex_);
+    if (!compute_done_) return;
 
-    const float scaled_x_step_div_render_step_width = scaled_x_step_ / render_step_width_;
-    const float scaled_y_step_div_render_step_width = scaled_y_step_ / render_step_width_;
+    std::swap(presented_grid_, fractal_.grid());
+    if (profiler_) profiler_->merge_current(compute_profiler_);
+    if (compute_cached_) frame_cache_.store(compute_key_, presented_grid_);
+    showing_cached_grid_ = false;
+    frame_started_at_ = compute_requested_at_;
 
-    for (int x = 0; x < grid_width_ - render_step_width_; x += render_step_width_) {
-        for (int y = 0; y < grid_height_ - render_step_width_; y += render_step_width_) {
-            if (are_corners_black(x, y)) continue;
-
-            fill_edges(x, y, scaled_x_step_div_render_step_width, scaled_y_step_div_render_step_width);
-            fill_checkerboard_pattern(x, y, scaled_x_step_div_render_step_width, scaled_y_step_div_render_step_width);
-            fill_rest_by_averaging_neighbors(x, y);
-        }
-    }
+    compute_done_ = false;
+    compute_busy_ = false;
 }
 
-void Sketch::render_sparse_grid() noexcept {
-    int x = 0;
-    float scaled_x = 0.0f;
-    while (x < grid_width_) {
-        render_sparse_grid_column(x, scaled_x);
-        x += render_step_width_;
-        scaled_x += scaled_x_step_;
+// Lets the frame in flight finish and shows it, so the caller can change the renderer
+void Sketch::wait_for_compute_() {
+    if (!pipelined_) return;
+    {
+        std::unique_lock<std::mutex> lock(compute_mutex_);
+        compute_finished_.wait(lock, [&] { return !compute_busy_ || compute_done_; });
     }
+    collect_computed_frame_();
+    apply_pending_settings_();
 }
 
-void Sketch::render_sparse_grid_column(int x, float scaled_x) noexcept {
-    int y = 0;
-    float scaled_y = -2.0f;
-    while (y < grid_height_) {
-        grid_[y][x] = is_in_set_(scaled_x, scaled_y);
-        y += render_step_width_;
-        scaled_y += scaled_y_step_;
-    }
+// Only called while the compute thread is idle
+void Sketch::apply_pending_settings_() {
+    if (view_pending_) fractal_.set_view(pending_view_);
+    if (pending_max_iterations_) fractal_.set_max_iterations(pending_max_iterations_);
+    view_pending_ = false;
+    pending_max_iterations_ = 0;
 }
 
-bool Sketch::are_corners_black(int x, int y) noexcept {
-    return (grid_[y][x] == 0.0f && grid_[y][x + render_step_width_] == 0.0f &&
-            grid_[y + render_step_width_][x] == 0.0f &&
-            grid_[y + render_step_width_][x + render_step_width_] == 0.0f) ||
-           (grid_[y][x] == 1.0f && grid_[y][x + render_step_width_] == 1.0f &&
-            grid_[y + render_step_width_][x] == 1.0f && grid_[y + render_step_width_][x + render_step_width_] == 1.0f);
+int Sketch::get_max_iterations_() const noexcept {
+    return pending_max_iterations_ ? pending_max_iterations_ : fractal_.get_max_iterations();
 }
 
-void Sketch::fill_edges(int x, int y, float scaled_x_step_div_render_step_width,
-                        float scaled_y_step_div_render_step_width) noexcept {
-    for (int i = 1; i < render_step_width_; i++) {
-        fill_edge(x, y, i, scaled_x_step_div_render_step_width, scaled_y_step_div_render_step_width);
+void Sketch::set_pipelined(const bool& enabled) {
+    if (!FLOW_THREADS || enabled == pipelined_) return;
+
+    if (enabled) {
+        compute_stopping_ = false;
+        compute_thread_ = std::thread([this] { compute_loop_(); });
+        fractal_.set_profiler(profiler_ ? &compute_profiler_ : nullptr);
+        pipelined_ = true;
+        // presented_grid_ has no frame yet
+        dirty_ = true;
+        return;
     }
-}
 
-void Sketch::fill_edge(int x, int y, int i, float scaled_x_step_div_render_step_width,
-                       float scaled_y_step_div_render_step_width) noexcept {
-    grid_[y][x + i] =
-        is_in_set_(scaled_x_step_div_render_step_width * (x + i), scaled_y_step_div_render_step_width * y - 2.0f);
-    grid_[y + render_step_width_][x + i] =
-        is_in_set_(scaled_x_step_div_render_step_width * (x + i),
-                   scaled_y_step_div_render_step_width * (y + render_step_width_) - 2.0f);
-    grid_[y + i][x] =
-        is_in_set_(scaled_x_step_div_render_step_width * x, scaled_y_step_div_render_step_width * (y + i) - 2.0f);
-    grid_[y + i][x + render_step_width_] = is_in_set_(scaled_x_step_div_render_step_width * (x + render_step_width_),
-                                                      scaled_y_step_div_render_step_width * (y + i) - 2.0f);
-}
-
-void Sketch::fill_checkerboard_pattern(int x, int y, float scaled_x_step_div_render_step_width,
-                                       float scaled_y_step_div_render_step_width) noexcept {
-    for (int i = 1; i < render_step_width_; i += 2) {
-        for (int j = 1; j < render_step_width_; j += 2) {
-            grid_[y + i][x + j] = is_in_set_(scaled_x_step_div_render_step_width * (x + j),
-                                             scaled_y_step_div_render_step_width * (y + i) - 2.0f);
-        }
-    }
-    for (int i = 2; i < render_step_width_; i += 2) {
-        for (int j = 2; j < render_step_width_; j += 2) {
-            grid_[y + i][x + j] = is_in_set_(scaled_x_step_div_render_step_width * (x + j),
-                                             scaled_y_step_div_render_step_width * (y + i) - 2.0f);
-        }
+    wait_for_compute_();
+    {
+        std::lock_guard<std::mutex> lock(compute_mutex_);
+        compute_stopping_ = true;
     }
+    compute_requested_.notify_one();
+    compute_thread_.join();
+    pipelined_ = false;
+    fractal_.set_profiler(profiler_);
+
+    // the renderer's grid is the last frame shown
+    std::swap(presented_grid_, fractal_.grid());
 }
 
-void Sketch::fill_rest_by_averaging_neighbors(int x, int y) noexcept {
-    for (int i = 1; i < render_step_width_; i += 2) {
-        for (int j = 2; j < render_step_width_; j += 2) {
-            grid_[y + i][x + j] = average_of_neighbors(x, y, i, j);
-        }
-    }
-    for (int i = 2; i < render_step_width_; i += 2) {
-        for (int j = 1; j < render_step_width_; j += 2) {
-            grid_[y + i][x + j] = average_of_neighbors(x, y, i, j);
-        }
-    }
+bool Sketch::load_cached_frame_(const FrameCache::Key& key) {
+    if (!frame_cache_.load(key, cached_grid_)) return false;
+    if (profiler_) profiler_->add_count(Profiler::cache_hits, 1);
+    return true;
 }
 
-float Sketch::average_of_neighbors(int x, int y, int i, int j) noexcept {
-    return (grid_[y + i - 1][x + j] + grid_[y + i + 1][x + j] + grid_[y + i][x + j - 1] + grid_[y + i][x + j + 1]) /
-           4.0f;
+void Sketch::draw() noexcept {
+    recolor_ = false;
+    {
+        Profiler::Scope scope(profiler_, Profiler::color);
+        color_framebuffer_();
+    }
+
+#if !FLOW_HEADLESS
+    Profiler::Scope scope(profiler_, Profiler::present);
+    upload_framebuffer_();
+
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
+    SDL_RenderClear(renderer_);
+
+    const SDL_Rect canvas_rect{canvas_offset_x_, canvas_offset_y_, canvas_width_, canvas_width_};
+    SDL_RenderCopy(renderer_, texture_, nullptr, &canvas_rect);
+
+    SDL_RenderPresent(renderer_);
+#endif
+
+    if (profiler_ && frame_started_at_ != std::chrono::steady_clock::time_point())
+        profiler_->add_time(Profiler::latency, std::chrono::steady_clock::now() - frame_started_at_);
 }
 
-inline void Sketch::calculate_c_() noexcept {
-    const size_t index = static_cast<size_t>(animation_progress_ * (c_points_.size() - 1));
-    const float progress = std::fmod(animation_progress_ * (c_points_.size() - 1), 1.0f);
+// Colors the grid into the framebuffer; a mirrored grid is the right half, and is mirrored onto the left half.
+// A pipelined frame computed before a resize keeps the previous image until the next one arrives.
+void Sketch::color_framebuffer_() noexcept {
+    const Grid& grid = get_shown_grid();
+    if (grid.width() != grid_width_ || grid.height() != grid_height_) return;
 
-    const auto& current_point = c_points_[index];
-    const auto& next_point = c_points_[index + 1];
+    palette_.map_grid(grid, fractal_.is_mirrored(), framebuffer_.data(), framebuffer_width_);
+    if (profiler_)
+        profiler_->add_count(Profiler::cells_drawn, static_cast<std::uint64_t>(framebuffer_width_) * grid_height_);
+}
 
-    c_real_ = current_point.first + (next_point.first - current_point.first) * progress;
-    c_imag_ = current_point.second + (next_point.second - current_point.second) * progress;
+const Grid& Sketch::get_shown_grid() const noexcept {
+    if (showing_cached_grid_) return cached_grid_;
+    return pipelined_ ? presented_grid_ : fractal_.grid();
 }
 
-// This function checks if a given point (x, y) is in the Julia set
-inline float Sketch::is_in_set_(const float& x, const float& y) const noexcept {
-    // Initialize constants for the real and imaginary parts of the complex constant c
-    const v128_t c_real = wasm_f32x4_splat(c_real_);
-    const v128_t c_imag = wasm_f32x4_splat(c_imag_);
+void Sketch::set_c(const float& c_real, const float& c_imag) noexcept {
+    c_real_ = c_real;
+    c_imag_ = c_imag;
+    c_pinned_ = true;
+    dirty_ = true;
+}
 
-    // Initialize constants for the number 2 and -2
-    const v128_t two = wasm_f32x4_splat(2.0f);
-    const v128_t neg_two = wasm_f32x4_splat(-2.0f);
+void Sketch::seek(const float& progress) noexcept {
+    animation_progress_ = wrap_progress_(progress);
+    c_pinned_ = false;
+}
 
-    // Initialize the maximum number of iterations
-    const v128_t max_iterations = wasm_f32x4_splat(static_cast<float>(max_iterations_));
+void Sketch::set_loop_range(const float& start, const float& end) noexcept {
+    const bool valid = start >= 0.0f && end <= 1.0f && start < end;
+    loop_start_ = valid ? start : 0.0f;
+    loop_end_ = valid ? end : 1.0f;
+    animation_progress_ = wrap_progress_(animation_progress_);
+}
 
-    // Initialize the real and imaginary parts of z
-    v128_t z_real = wasm_f32x4_splat(x);
-    v128_t z_imag = wasm_f32x4_splat(y);
+// Wraps a progress into the loop range, from either side
+float Sketch::wrap_progress_(float progress) const noexcept {
+    const float length = loop_end_ - loop_start_;
+    progress = loop_start_ + std::fmod(progress - loop_start_, length);
+    if (progress < loop_start_) progress += length;
+    return progress < loop_end_ ? progress : loop_start_;
+}
 
-    // Initialize the iteration counter
-    int iterations = 0;
+int Sketch::frame_slot_() const noexcept {
+    return std::min(static_cast<int>(animation_progress_ * frame_cache_slots_), frame_cache_slots_ - 1);
+}
 
-    // Iterate until the maximum number of iterations is reached
-    while (++iterations < max_iterations_) {
-        // Calculate the squares of the real and imaginary parts of z
-        const v128_t z_real_squared = wasm_f32x4_mul(z_real, z_real);
-        const v128_t z_imag_squared = wasm_f32x4_mul(z_imag, z_imag);
+void Sketch::set_window_size(const int& width, const int& height) noexcept {
+    window_width_ = width;
+    window_height_ = height;
+    setup();
+}
 
-        // Update the real part of z
-        v128_t z_real_temp = wasm_f32x4_sub(z_real_squared, z_imag_squared);
-        z_real_temp = wasm_f32x4_add(z_real_temp, c_real);
+// Called every frame by the quality controller, so it only touches the renderer when something changed, and a new
+// iteration cap waits for the next request in pipelined mode; a new resolution changes the grid layout and waits
+// for the frame in flight
+void Sketch::set_quality(const int& resolution, const int& max_iterations) {
+    const int clamped_iterations = std::max(2, max_iterations);
+    const bool iterations_changed = clamped_iterations != get_max_iterations_();
+    if (!iterations_changed && resolution == resolution_) return;
+    if (iterations_changed) dirty_ = true;
+
+    if (pipelined_ && resolution == resolution_) {
+        pending_max_iterations_ = clamped_iterations;
+        return;
+    }
+    wait_for_compute_();
+    fractal_.set_max_iterations(clamped_iterations);
+    if (resolution == resolution_) return;
 
-        // Update the imaginary part of z
-        z_imag = wasm_f32x4_mul(wasm_f32x4_mul(z_real, z_imag), two);
-        z_imag = wasm_f32x4_add(z_imag, c_imag);
+    resolution_ = resolution;
+    setup();
+}
 
-        // Update the real part of z
-        z_real = z_real_temp;
+// Switching between the mirrored and the full grid changes the framebuffer layout, which only happens when leaving
+// or returning to the default view; only then a pipelined frame in flight is waited for, and otherwise the view is
+// handed to the renderer with the next request.
+// Cached frames are only valid for the view they were rendered with.
+void Sketch::set_view(const FractalRenderer::View& view) {
+    const FractalRenderer::View previous = get_view();
+    if (pipelined_ && view != FractalRenderer::View() && previous != FractalRenderer::View()) {
+        pending_view_ = view;
+        pending_view_.half_height = std::clamp<double>(view.half_height, fractal_.get_min_half_height(),
+                                                       FractalRenderer::default_view_half_height);
+        view_pending_ = true;
+    } else {
+        wait_for_compute_();
+        fractal_.set_view(view);
+        if (fractal_.grid().width() != grid_width_) setup();
+    }
+    if (get_view() != previous) {
+        frame_cache_.clear();
+        std::lock_guard<std::mutex> lock(compute_mutex_);
+        compute_cached_ = false;
+        dirty_ = true;
+    }
+}
 
-        // Check if z has escaped the circle of radius 2
-        const v128_t out_of_bounds =
-            wasm_v128_or(wasm_v128_or(wasm_f32x4_gt(z_real, two), wasm_f32x4_lt(z_real, neg_two)),
-                         wasm_v128_or(wasm_f32x4_gt(z_imag, two), wasm_f32x4_lt(z_imag, neg_two)));
+void Sketch::reset_view() { set_view(FractalRenderer::View()); }
 
-        // If z has escaped, break the loop
-        if (wasm_v128_any_true(out_of_bounds)) break;
+void Sketch::set_formula(const FractalRenderer::Formula& formula) {
+    wait_for_compute_();
+    if (formula != fractal_.get_formula()) {
+        frame_cache_.clear();
+        dirty_ = true;
     }
+    fractal_.set_formula(formula);
+    if (fractal_.grid().width() != grid_width_) setup();
+}
 
-    // If only one iteration was done, return 0
-    if (iterations == 1) return 0.0f;
+// Zooms by factor (below 1 zooms in) around a window position, keeping the point under it in place
+void Sketch::zoom_at(const int& window_x, const int& window_y, const double& factor) {
+    FractalRenderer::View view = get_view();
+    const double unit = window_unit_();
+    const double offset_x = (window_x - canvas_offset_x_ - canvas_width_ / 2.0) * unit;
+    const double offset_y = (window_y - canvas_offset_y_ - canvas_width_ / 2.0) * unit;
+    const double new_half_height = std::clamp<double>(view.half_height * factor, fractal_.get_min_half_height(),
+                                                      FractalRenderer::default_view_half_height);
+    const double applied_factor = new_half_height / view.half_height;
+
+    view.center_x += offset_x * (1.0 - applied_factor);
+    view.center_y += offset_y * (1.0 - applied_factor);
+    view.half_height = new_half_height;
+    // zooming all the way out returns to the symmetric default view
+    if (new_half_height == FractalRenderer::default_view_half_height) view = FractalRenderer::View();
+    set_view(view);
+}
 
-    // Calculate the modulus of z
-    const v128_t mod_squared = wasm_f32x4_add(wasm_f32x4_mul(z_real, z_real), wasm_f32x4_mul(z_imag, z_imag));
-    const v128_t mod = wasm_f32x4_sqrt(mod_squared);
+// Moves the view by a drag of window pixels
+void Sketch::pan(const int& window_dx, const int& window_dy) {
+    FractalRenderer::View view = get_view();
+    const double unit = window_unit_();
+    view.center_x -= window_dx * unit;
+    view.center_y -= window_dy * unit;
+    set_view(view);
+}
 
-    // Calculate the average modulus
-    const float scalar_mod = (wasm_f32x4_extract_lane(mod, 0) + wasm_f32x4_extract_lane(mod, 1) +
-                              wasm_f32x4_extract_lane(mod, 2) + wasm_f32x4_extract_lane(mod, 3)) /
-                             4.0f;
+// The size of a window pixel in the plane
+double Sketch::window_unit_() const noexcept {
+    return 2.0 * get_view().half_height / std::max(1, canvas_width_);
+}
 
-    // Calculate the logarithm of the average modulus
-    const float log_scalar_mod = fast_log2(std::max(1.0f, fast_log2(scalar_mod)));
+void Sketch::set_thread_count(const std::size_t& thread_count) {
+    wait_for_compute_();
+    fractal_.set_thread_count(thread_count);
+}
 
-    // Calculate the smooth color
-    const float smooth = static_cast<float>(iterations) - log_scalar_mod;
-    const float t = smooth / static_cast<float>(max_iterations_);
+std::size_t Sketch::get_thread_count() const noexcept { return fractal_.get_thread_count(); }
 
-    // If t is close to 1.0f or 0.0f, then make it exactly 1.0f or 0.0f
-    return (t > 0.999f) ? 1.0f : ((t < 0.001f) ? 0.0f : t);
+void Sketch::set_profiler(Profiler* profiler) {
+    wait_for_compute_();
+    profiler_ = profiler;
+    fractal_.set_profiler(pipelined_ && profiler ? &compute_profiler_ : profiler);
 }
 
-inline std::tuple<int, int, int> Sketch::get_color_(const float& t) const noexcept {
-    const float inverse_t = 1 - t;
-    const float t_squared = t * t;
-    const float t_cubed = t_squared * t;
+void Sketch::set_palette(const std::vector<Palette::Stop>& stops) {
+    palette_.set_gradient(stops);
+    recolor_ = true;
+}
 
-    const int r = static_cast<int>(9 * inverse_t * t_cubed * 255);
-    const int g = static_cast<int>(15 * inverse_t * inverse_t * t_squared * 255);
-    const int b = static_cast<int>(8.5 * inverse_t * inverse_t * inverse_t * t * 255);
+void Sketch::reset_palette() noexcept {
+    palette_.set_default();
+    recolor_ = true;
+}
 
-    return std::make_tuple(r, g, b);
+void Sketch::set_frame_cache(const bool& enabled, const std::size_t& budget) {
+    frame_cache_enabled_ = enabled;
+    frame_cache_.set_budget(budget);
+    if (!enabled) frame_cache_.clear();
 }
 
-void Sketch::draw_rect_(const int& x, const int& y) {
-    SDL_Rect rect{canvas_offset_x_ + canvas_center_ + x * cell_width_, canvas_offset_y_ + y * cell_width_, cell_width_,
-                  cell_width_};
-    SDL_Rect rect_mirror{canvas_offset_x_ + canvas_center_ - x * cell_width_ - cell_width_,
-                         canvas_offset_y_ + canvas_width_ - y * cell_width_ - cell_width_, cell_width_, cell_width_};
-    SDL_RenderFillRect(renderer_, &rect);
-    SDL_RenderFillRect(renderer_, &rect_mirror);
+void Sketch::setup_framebuffer_() {
+    const int framebuffer_width = fractal_.is_mirrored() ? grid_width_ * 2 : grid_width_;
+    const int framebuffer_height = grid_height_;
+    framebuffer_.assign(framebuffer_width * framebuffer_height, 0xFF000000);
+    if (texture_ && framebuffer_width == framebuffer_width_ && framebuffer_height == framebuffer_height_) return;
+
+    framebuffer_width_ = framebuffer_width;
+    framebuffer_height_ = framebuffer_height;
+#if !FLOW_HEADLESS
+    if (texture_) SDL_DestroyTexture(texture_);
+    texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, framebuffer_width_,
+                                 framebuffer_height_);
+    if (!texture_) {
+        std::cout << "Failed to create framebuffer texture\n";
+        std::cout << "SDL2 Error: " << SDL_GetError() << "\n";
+        return;
+    }
+    SDL_SetTextureScaleMode(texture_, SDL_ScaleModeNearest);
+#endif
 }
 
-inline float fast_log2(float x) {
-    union {
-        float f;
-        uint32_t i;
-    } vx = {x};
-    union {
-        uint32_t i;
-        float f;
-    } mx = {(vx.i & 0x007FFFFF) | 0x3f000000};
+#if !FLOW_HEADLESS
+// Copies the framebuffer into the streaming texture, in one go when the texture rows are not padded
+void Sketch::upload_framebuffer_() noexcept {
+    void* pixels;
+    int pitch;
+    if (!texture_ || SDL_LockTexture(texture_, nullptr, &pixels, &pitch) != 0) return;
+
+    const std::size_t row_size = framebuffer_width_ * sizeof(std::uint32_t);
+    if (static_cast<std::size_t>(pitch) == row_size) {
+        std::memcpy(pixels, framebuffer_.data(), row_size * framebuffer_height_);
+    } else {
+        for (int y = 0; y < framebuffer_height_; y++) {
+            std::memcpy(static_cast<Uint8*>(pixels) + y * pitch, framebuffer_.data() + y * framebuffer_width_,
+                        row_size);
+        }
+    }
 
-    float y = vx.i * 1.1920928955078125e-7f;
-    return y - 124.22551499f - 1.498030302f * mx.f - 1.72587999f / (0.3520887068f + mx.f);
-}
\ No newline at end of file
+    SDL_UnlockTexture(texture_);
+}
+#endif
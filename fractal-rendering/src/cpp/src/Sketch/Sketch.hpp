@@ -1,21 +1,98 @@
 #ifndef SKETCH_HPP
 #define SKETCH_HPP
 
+#if FLOW_HEADLESS
+// the replay tool has no window: the sketch still colors its framebuffer, but presents nothing
+struct SDL_Renderer;
+struct SDL_Texture;
+#else
 #include <SDL2/SDL.h>
-#include <wasm_simd128.h>
+#endif
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <numeric>
+#include <thread>
+#include <tuple>
+
+#include "../CPath/CPath.hpp"
+#include "../FractalRenderer/FractalRenderer.hpp"
+#include "../FrameCache/FrameCache.hpp"
+#include "../Palette/Palette.hpp"
 
 class Sketch {
    public:
+    // renderer is null in headless builds
     Sketch(SDL_Renderer *renderer);
+    ~Sketch();
 
     void setup();
-    void update(const double &delta_time);
+    // Moves the c animation along its timeline by delta_time milliseconds
+    void advance(const double &delta_time) noexcept;
+    // Renders the frame if anything it depends on changed since the last one
+    void update();
     void draw() noexcept;
+    // A frame is only needed once c, the window or a setting changed since the last one, or while a pipelined frame
+    // is in flight; otherwise update and draw have nothing to do
+    bool needs_frame() const noexcept { return dirty_ || recolor_ || (pipelined_ && compute_busy_); }
+    // The timeline moves c by itself, so new frames keep coming
+    bool is_animating() const noexcept { return !paused_ && !c_pinned_; }
     void set_window_size(const int &width, const int &height) noexcept;
+    void set_quality(const int &resolution, const int &max_iterations);
+    void set_view(const FractalRenderer::View &view);
+    void reset_view();
+    // Keeps the view, within the zoom depth the formula supports
+    void set_formula(const FractalRenderer::Formula &formula);
+    const FractalRenderer::View &get_view() const noexcept {
+        return view_pending_ ? pending_view_ : fractal_.get_view();
+    }
+    FractalRenderer::Formula get_formula() const noexcept { return fractal_.get_formula(); }
+    const char *get_kernel_isa() const noexcept { return fractal_.get_kernel_isa(); }
+    void zoom_at(const int &window_x, const int &window_y, const double &factor);
+    void pan(const int &window_dx, const int &window_dy);
+    // Timeline of the c animation: the progress runs through the loop range at the playback rate, 1 being the
+    // default speed and a negative rate playing backwards
+    void set_paused(const bool &paused) noexcept { paused_ = paused; }
+    bool is_paused() const noexcept { return paused_; }
+    // Also returns c to the animation if it was pinned
+    void seek(const float &progress) noexcept;
+    void set_playback_rate(const float &rate) noexcept { playback_rate_ = rate; }
+    float get_playback_rate() const noexcept { return playback_rate_; }
+    // A range that is empty or outside [0, 1] is the whole loop
+    void set_loop_range(const float &start, const float &end) noexcept;
+    float get_loop_start() const noexcept { return loop_start_; }
+    float get_loop_end() const noexcept { return loop_end_; }
+    float get_progress() const noexcept { return animation_progress_; }
+    // Holds c at a fixed value instead of the animation, until animate_c
+    void set_c(const float &c_real, const float &c_imag) noexcept;
+    void animate_c() noexcept { c_pinned_ = false; }
+    bool is_c_pinned() const noexcept { return c_pinned_; }
+    float get_c_real() const noexcept { return c_real_; }
+    float get_c_imag() const noexcept { return c_imag_; }
+    void set_thread_count(const std::size_t &thread_count);
+    std::size_t get_thread_count() const noexcept;
+    void set_profiler(Profiler *profiler);
+    void set_palette(const std::vector<Palette::Stop> &stops);
+    void reset_palette() noexcept;
+    // Keeps the frames of the c animation loop to replay them on the next loops, within budget bytes
+    void set_frame_cache(const bool &enabled, const std::size_t &budget);
+    const FrameCache &get_frame_cache() const noexcept { return frame_cache_; }
+    bool is_frame_cache_enabled() const noexcept { return frame_cache_enabled_; }
+    // Computes the next frame on a thread of its own while the current one is colored and presented, which shows
+    // every frame one update later; needs FLOW_THREADS
+    void set_pipelined(const bool &enabled);
+    bool is_pipelined() const noexcept { return pipelined_; }
+    // duration of the last completed render, which the pipelined update does not wait for
+    double get_render_ms() const noexcept { return render_ms_; }
+    // The grid the last draw colored: the rendered one, or the one replayed from the frame cache or presented by the
+    // pipeline
+    const Grid &get_shown_grid() const noexcept;
 
    private:
     SDL_Renderer *renderer_;
@@ -27,50 +104,87 @@ class Sketch {
     int canvas_offset_x_ = 0;
     int canvas_offset_y_ = 0;
 
+    // colored grid with both symmetric halves, streamed to the texture once per frame
+    SDL_Texture *texture_ = nullptr;
+    std::vector<std::uint32_t> framebuffer_;
+    int framebuffer_width_ = 0;
+    int framebuffer_height_ = 0;
+    Palette palette_;
+
     int grid_height_ = 0;
     int grid_width_ = 0;
-    std::vector<std::vector<float>> grid_;
+
+    FractalRenderer fractal_;
+    Profiler *profiler_ = nullptr;
 
     int resolution_ = 600;
-    int render_step_width_ = 6;
     int cell_width_ = 0;
-    float scaled_x_step_ = 0.0f;
-    float scaled_y_step_ = 0.0f;
 
-    int max_iterations_ = 50;
     float c_real_ = 0.0f;
     float c_imag_ = 0.0f;
 
-    // interpolation animation for c_ between multiple points
-    using Point = std::pair<float, float>;
-    std::vector<Point> c_points_ = {
-        {0.0f, 0.0f},    {-0.4f, -0.59f},    {-0.702f, -0.384f},  {-0.835f, -0.2321f}, {-2.0f, 0.0f},
-        {-0.8f, 0.156f}, {-0.835f, 0.2321f}, {-0.7269f, 0.1889f}, {-0.54f, 0.54f},     {-0.4f, 0.6f},
-        {0.0f, 0.8f},    {0.078f, 0.656f},   {0.355f, 0.355f},    {0.45f, 0.1428f},    {0.37f, 0.1f},
-        {0.285f, 0.01},  {0.285f, 0.0f},     {0.34f, -0.05},      {0.0f, 0.0f},
-    };
-
+    // c_ follows c_path_ while the animation runs
+    CPath c_path_;
     float animation_progress_ = 0.0f;
     float animation_speed_ = 0.00001f;
+    float playback_rate_ = 1.0f;
+    float loop_start_ = 0.0f;
+    float loop_end_ = 1.0f;
+    bool paused_ = false;
+    bool c_pinned_ = false;
 
-    void render_grid_() noexcept;
-    void render_sparse_grid() noexcept;
-    void render_sparse_grid_column(int x, float scaled_x) noexcept;
-    bool are_corners_black(int x, int y) noexcept;
-    void fill_edges(int x, int y, float scaled_x_step_div_render_step_width,
-                    float scaled_y_step_div_render_step_width) noexcept;
-    void fill_edge(int x, int y, int i, float scaled_x_step_div_render_step_width,
-                   float scaled_y_step_div_render_step_width) noexcept;
-    void fill_checkerboard_pattern(int x, int y, float scaled_x_step_div_render_step_width,
-                                   float scaled_y_step_div_render_step_width) noexcept;
-    void fill_rest_by_averaging_neighbors(int x, int y) noexcept;
-    float average_of_neighbors(int x, int y, int i, int j) noexcept;
-    void calculate_c_() noexcept;
-    float is_in_set_(const float &x, const float &y) const noexcept;
-    std::tuple<int, int, int> get_color_(const float &t) const noexcept;
-    void draw_rect_(const int &x, const int &y);
-};
+    // set when the next update has to render, and when only the palette changed since the last draw
+    bool dirty_ = true;
+    bool recolor_ = false;
 
-inline float fast_log2(float x);
+    // with the frame cache, the animation renders c at frame_cache_slots_ fixed points of the loop, so a frame can be
+    // replayed from cached_grid_ whenever the progress comes back to its slot
+    FrameCache frame_cache_;
+    bool frame_cache_enabled_ = false;
+    int frame_cache_slots_ = 2048;
+    Grid cached_grid_;
+    bool showing_cached_grid_ = false;
+
+    // Pipelined mode: the compute thread renders into the renderer's grid while presented_grid_ is shown. A frame is
+    // requested by setting compute_busy_, and once compute_done_ is set the main thread swaps it into presented_grid_.
+    // The renderer is only touched by the main thread while no frame is in flight (see wait_for_compute_).
+    bool pipelined_ = false;
+    std::thread compute_thread_;
+    std::mutex compute_mutex_;
+    std::condition_variable compute_requested_;
+    std::condition_variable compute_finished_;
+    bool compute_busy_ = false;
+    bool compute_done_ = false;
+    bool compute_stopping_ = false;
+    Profiler compute_profiler_;
+    Grid presented_grid_;
+    FrameCache::Key compute_key_;
+    // cleared when the view changes under the frame in flight, whose grid then no longer belongs under its key
+    bool compute_cached_ = false;
+    std::chrono::steady_clock::time_point compute_requested_at_;
+    std::atomic<double> render_ms_ = 0.0;
+    // The view and iteration cap change with every mouse event and quality step; while a frame is in flight they are
+    // kept here and handed to the renderer with the next request, so the main loop does not wait for the frame
+    bool view_pending_ = false;
+    FractalRenderer::View pending_view_;
+    int pending_max_iterations_ = 0;
+
+    // when the c of the frame being shown was taken, the epoch before the first one
+    std::chrono::steady_clock::time_point frame_started_at_;
+
+    float wrap_progress_(float progress) const noexcept;
+    int frame_slot_() const noexcept;
+    bool load_cached_frame_(const FrameCache::Key &key);
+    void update_pipelined_(const FrameCache::Key &key, const bool &cached);
+    void compute_loop_();
+    void collect_computed_frame_();
+    void wait_for_compute_();
+    void apply_pending_settings_();
+    int get_max_iterations_() const noexcept;
+    double window_unit_() const noexcept;
+    void color_framebuffer_() noexcept;
+    void setup_framebuffer_();
+    void upload_framebuffer_() noexcept;
+};
 
 #endif
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "TileCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr const char *tile_extension = ".ppm";
+constexpr const char *temporary_extension = ".tmp";
+
+}  // namespace
+
+TileCache::Tile::Tile(std::vector<std::uint8_t> bytes) : bytes_(std::move(bytes)) {
+    data_ = bytes_.data();
+    size_ = bytes_.size();
+}
+
+TileCache::Tile::~Tile() {
+#if !defined(_WIN32)
+    if (mapping_) munmap(mapping_, size_);
+#endif
+}
+
+// Without mmap, the file is read into memory instead
+std::shared_ptr<const TileCache::Tile> TileCache::Tile::map(const std::string &path) {
+#if defined(_WIN32)
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) return nullptr;
+    std::vector<std::uint8_t> bytes;
+    std::uint8_t buffer[1 << 16];
+    std::size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + read);
+    const bool failed = std::ferror(file) || bytes.empty();
+    std::fclose(file);
+    return failed ? nullptr : std::make_shared<const Tile>(std::move(bytes));
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) return nullptr;
+
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+        mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+    // the mapping stays valid once the file is closed, and even once it is removed
+    close(file);
+    if (mapping == MAP_FAILED) return nullptr;
+
+    std::shared_ptr<Tile> tile(new Tile());
+    tile->mapping_ = mapping;
+    tile->data_ = static_cast<const std::uint8_t *>(mapping);
+    tile->size_ = static_cast<std::size_t>(status.st_size);
+    return tile;
+#endif
+}
+
+TileCache::TileCache(const std::size_t &memory_budget, const std::string &directory, const std::size_t &disk_budget)
+    : directory_(directory) {
+    memory_.budget = memory_budget;
+    disk_.budget = disk_budget;
+    if (!directory_.empty()) scan_directory_();
+}
+
+TileCache::Source TileCache::load(const std::string &key, std::shared_ptr<const Tile> &tile) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto entry = memory_.find(key);
+        if (entry != memory_.entries.end()) {
+            tile = entry->tile;
+            return memory;
+        }
+        if (directory_.empty() || disk_.find(key) == disk_.entries.end()) return missing;
+    }
+
+    // Mapped outside the lock; the file may have been evicted since
+    const std::string path = path_(key);
+    tile = Tile::map(path);
+    if (!tile) return missing;
+    std::error_code error;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_.insert({key, tile->size(), tile});
+    memory_.evict();
+    return disk;
+}
+
+// The file is written next to its final name and renamed, so a reader never maps a partial tile
+bool TileCache::store(const std::string &key, const std::shared_ptr<const Tile> &tile) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        memory_.insert({key, tile->size(), tile});
+        memory_.evict();
+    }
+    if (directory_.empty()) return true;
+
+    const std::string path = path_(key);
+    const std::string temporary = path + temporary_extension;
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    bool written = file && std::fwrite(tile->data(), 1, tile->size(), file) == tile->size();
+    if (file) written = std::fclose(file) == 0 && written;
+
+    std::error_code error;
+    if (written) std::filesystem::rename(temporary, path, error);
+    if (!written || error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    std::vector<std::string> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        disk_.insert({key, tile->size(), nullptr});
+        evicted = disk_.evict();
+    }
+    remove_files_(evicted);
+    return true;
+}
+
+std::size_t TileCache::get_memory_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_.size;
+}
+
+std::size_t TileCache::get_disk_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return disk_.size;
+}
+
+std::list<TileCache::Entry>::iterator TileCache::Tier::find(const std::string &key) {
+    const auto found = index.find(key);
+    if (found == index.end()) return entries.end();
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second;
+}
+
+void TileCache::Tier::insert(Entry entry) {
+    const auto found = index.find(entry.key);
+    if (found != index.end()) {
+        size -= found->second->size;
+        entries.erase(found->second);
+    }
+
+    size += entry.size;
+    entries.push_front(std::move(entry));
+    index[entries.front().key] = entries.begin();
+}
+
+std::vector<std::string> TileCache::Tier::evict() {
+    std::vector<std::string> evicted;
+    while (size > budget && !entries.empty()) {
+        Entry &entry = entries.back();
+        size -= entry.size;
+        index.erase(entry.key);
+        evicted.push_back(std::move(entry.key));
+        entries.pop_back();
+    }
+    return evicted;
+}
+
+std::string TileCache::path_(const std::string &key) const {
+    return (std::filesystem::path(directory_) / (key + tile_extension)).string();
+}
+
+// Picks up the tiles of an earlier run, oldest first so the newest end up most recently used, and drops the files
+// a run left half written
+void TileCache::scan_directory_() {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    fs::create_directories(directory_, error);
+
+    struct File {
+        std::string key;
+        std::size_t size;
+        fs::file_time_type time;
+    };
+    std::vector<File> files;
+    for (const fs::directory_entry &entry : fs::directory_iterator(directory_, error)) {
+        if (!entry.is_regular_file(error)) continue;
+        const fs::path &path = entry.path();
+        if (path.extension() == temporary_extension) {
+            fs::remove(path, error);
+        } else if (path.extension() == tile_extension) {
+            files.push_back({path.stem().string(), static_cast<std::size_t>(entry.file_size(error)),
+                             entry.last_write_time(error)});
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const File &a, const File &b) { return a.time < b.time; });
+    for (File &file : files) disk_.insert({std::move(file.key), file.size, nullptr});
+    remove_files_(disk_.evict());
+}
+
+void TileCache::remove_files_(const std::vector<std::string> &keys) const {
+    std::error_code error;
+    for (const std::string &key : keys) std::filesystem::remove(path_(key), error);
+}
@@ -0,0 +1,89 @@
+#ifndef TILE_CACHE_HPP
+#define TILE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Encoded tiles by key in two least recently used tiers, each under a byte budget: memory, and behind it a directory
+// with one file per tile. Stores write through to the directory, so tiles evicted from memory are still found there,
+// and tiles found there are served from a memory map of their file and kept in memory from then on.
+// The directory outlives the process: tiles already in it are picked up, least recently used first by their
+// modification time, which every hit refreshes.
+// All members can be called from any thread.
+class TileCache {
+   public:
+    // Tile bytes, either owned or mapped from a file of the directory
+    class Tile {
+       public:
+        explicit Tile(std::vector<std::uint8_t> bytes);
+        ~Tile();
+
+        Tile(const Tile &) = delete;
+        Tile &operator=(const Tile &) = delete;
+
+        // Returns null when the file can not be read
+        static std::shared_ptr<const Tile> map(const std::string &path);
+
+        const std::uint8_t *data() const noexcept { return data_; }
+        std::size_t size() const noexcept { return size_; }
+
+       private:
+        Tile() = default;
+
+        std::vector<std::uint8_t> bytes_;
+        void *mapping_ = nullptr;
+        const std::uint8_t *data_ = nullptr;
+        std::size_t size_ = 0;
+    };
+
+    enum Source { missing, memory, disk };
+
+    // An empty directory keeps tiles in memory only
+    TileCache(const std::size_t &memory_budget, const std::string &directory, const std::size_t &disk_budget);
+
+    // Marks the tile as recently used in the tier it came from
+    Source load(const std::string &key, std::shared_ptr<const Tile> &tile);
+    // Returns false when the tile could only be kept in memory
+    bool store(const std::string &key, const std::shared_ptr<const Tile> &tile);
+
+    // bytes held by each tier
+    std::size_t get_memory_size() const;
+    std::size_t get_disk_size() const;
+
+   private:
+    struct Entry {
+        std::string key;
+        std::size_t size = 0;
+        std::shared_ptr<const Tile> tile;
+    };
+
+    // Most recently used first
+    struct Tier {
+        std::size_t budget = 0;
+        std::size_t size = 0;
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+        std::list<Entry>::iterator find(const std::string &key);
+        void insert(Entry entry);
+        // Removes the least recently used entries until the tier fits its budget, and returns their keys
+        std::vector<std::string> evict();
+    };
+
+    mutable std::mutex mutex_;
+    Tier memory_;
+    Tier disk_;
+    std::string directory_;
+
+    std::string path_(const std::string &key) const;
+    void scan_directory_();
+    void remove_files_(const std::vector<std::string> &keys) const;
+};
+
+#endif
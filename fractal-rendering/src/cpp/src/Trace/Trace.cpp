@@ -0,0 +1,111 @@
+#include "Trace.hpp"
+
+namespace {
+
+constexpr char magic[8] = {'F', 'L', 'O', 'W', 'T', 'R', 'C', 'E'};
+
+}  // namespace
+
+void TraceWriter::clear() {
+    data_.assign(magic, magic + sizeof(magic));
+    put_(version);
+}
+
+void TraceWriter::tick(const double &delta_time) {
+    put_(TraceRecord::tick);
+    put_(static_cast<float>(delta_time));
+}
+
+void TraceWriter::resize(const int &width, const int &height) {
+    put_(TraceRecord::resize);
+    put_(static_cast<std::int32_t>(width));
+    put_(static_cast<std::int32_t>(height));
+}
+
+void TraceWriter::wheel(const int &window_x, const int &window_y, const int &notches) {
+    put_(TraceRecord::wheel);
+    put_(static_cast<std::int32_t>(window_x));
+    put_(static_cast<std::int32_t>(window_y));
+    put_(static_cast<std::int32_t>(notches));
+}
+
+void TraceWriter::drag(const int &window_dx, const int &window_dy) {
+    put_(TraceRecord::drag);
+    put_(static_cast<std::int32_t>(window_dx));
+    put_(static_cast<std::int32_t>(window_dy));
+}
+
+// Most commands take one or two arguments, so the zeros after the last used one are not stored
+void TraceWriter::command(const Command &command) {
+    std::uint8_t count = Command::arg_count;
+    while (count > 0 && command.args[count - 1] == 0.0) count--;
+
+    put_(TraceRecord::page_command);
+    put_(static_cast<std::uint8_t>(command.type));
+    put_(count);
+    for (int i = 0; i < count; i++) put_(command.args[i]);
+}
+
+void TraceWriter::quality(const int &resolution, const int &max_iterations) {
+    put_(TraceRecord::quality);
+    put_(static_cast<std::int32_t>(resolution));
+    put_(static_cast<std::int32_t>(max_iterations));
+}
+
+bool TraceReader::open(const std::uint8_t *data, const std::size_t &size) noexcept {
+    data_ = data;
+    size_ = size;
+    offset_ = 0;
+    corrupt_ = false;
+
+    char header[sizeof(magic)];
+    std::uint32_t trace_version = 0;
+    return get_(header) && std::memcmp(header, magic, sizeof(magic)) == 0 && get_(trace_version) &&
+           trace_version == TraceWriter::version;
+}
+
+bool TraceReader::next(TraceRecord &record) noexcept {
+    if (offset_ == size_) return false;
+
+    std::uint8_t kind = 0;
+    get_(kind);
+    record.kind = static_cast<TraceRecord::Kind>(kind);
+
+    bool complete = false;
+    switch (record.kind) {
+        case TraceRecord::tick: {
+            float delta_time = 0.0f;
+            complete = get_(delta_time);
+            record.delta_time = delta_time;
+            break;
+        }
+        case TraceRecord::resize:
+        case TraceRecord::drag:
+        case TraceRecord::quality:
+            complete = get_ints_(record, 2);
+            break;
+        case TraceRecord::wheel:
+            complete = get_ints_(record, 3);
+            break;
+        case TraceRecord::page_command: {
+            std::uint8_t type = 0, count = 0;
+            complete = get_(type) && get_(count) && count <= Command::arg_count;
+            record.command = Command();
+            record.command.type = type;
+            for (int i = 0; complete && i < count; i++) complete = get_(record.command.args[i]);
+            break;
+        }
+    }
+
+    corrupt_ = !complete;
+    return complete;
+}
+
+bool TraceReader::get_ints_(TraceRecord &record, const int &count) noexcept {
+    for (int i = 0; i < count; i++) {
+        std::int32_t value;
+        if (!get_(value)) return false;
+        record.values[i] = value;
+    }
+    return true;
+}
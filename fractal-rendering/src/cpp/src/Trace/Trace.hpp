@@ -0,0 +1,92 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../messaging/CommandQueue.hpp"
+
+// Trace of everything that drives the app, in the order it saw them: window events, page commands, the time between
+// loop wakeups and the quality frames were rendered at. The app records it (see Session::set_trace) and fractal_replay
+// feeds it back. Values are in the native byte order, little-endian on every target the app builds for:
+//   header   "FLOWTRCE", uint32 version
+//   records  uint8 kind, then by kind
+//     tick          float32 delta time, ms
+//     resize        int32 window width, height
+//     wheel         int32 window x, y, notches
+//     drag          int32 window dx, dy
+//     page_command  uint8 type, uint8 argument count n, n float64 arguments; trailing zero arguments are left out
+//     quality       int32 resolution, max iterations
+struct TraceRecord {
+    enum Kind : std::uint8_t {
+        tick = 1,
+        resize,
+        wheel,
+        drag,
+        page_command,
+        quality,
+    };
+
+    Kind kind = tick;
+    double delta_time = 0.0;
+    // the int32 fields of the record, in order
+    int values[3] = {};
+    Command command;
+};
+
+class TraceWriter {
+   public:
+    // page commands are stored by Command::Type, so renumbering them needs a new version
+    static constexpr std::uint32_t version = 2;
+
+    TraceWriter() { clear(); }
+
+    // Drops all records and keeps the header
+    void clear();
+    void tick(const double &delta_time);
+    void resize(const int &width, const int &height);
+    void wheel(const int &window_x, const int &window_y, const int &notches);
+    void drag(const int &window_dx, const int &window_dy);
+    void command(const Command &command);
+    void quality(const int &resolution, const int &max_iterations);
+
+    const std::vector<std::uint8_t> &data() const noexcept { return data_; }
+
+   private:
+    std::vector<std::uint8_t> data_;
+
+    template <typename T>
+    void put_(const T &value) {
+        const std::size_t offset = data_.size();
+        data_.resize(offset + sizeof(T));
+        std::memcpy(data_.data() + offset, &value, sizeof(T));
+    }
+};
+
+class TraceReader {
+   public:
+    // Returns false when data does not start with the header of a trace of this version
+    bool open(const std::uint8_t *data, const std::size_t &size) noexcept;
+    // Returns false at the end of the trace, and on a record that is cut off or of an unknown kind (see is_corrupt)
+    bool next(TraceRecord &record) noexcept;
+    bool is_corrupt() const noexcept { return corrupt_; }
+
+   private:
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t offset_ = 0;
+    bool corrupt_ = false;
+
+    template <typename T>
+    bool get_(T &value) noexcept {
+        if (size_ - offset_ < sizeof(T)) return false;
+        std::memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+    bool get_ints_(TraceRecord &record, const int &count) noexcept;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "WorkerPool.hpp"
+
+WorkerPool::WorkerPool(std::size_t thread_count) { start_(thread_count); }
+
+WorkerPool::~WorkerPool() { stop_(); }
+
+void WorkerPool::run(std::size_t task_count, const Task &task) {
+    if (!task_count) return;
+
+    {
+        // The queues are filled under the same lock that publishes the task, so no worker sees a queued index
+        // without it. Contiguous ranges are dealt out so neighboring tasks stay on the same worker until stolen.
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::size_t worker_count = queues_.size();
+        for (std::size_t worker = 0; worker < worker_count; worker++) {
+            const std::size_t begin = task_count * worker / worker_count;
+            const std::size_t end = task_count * (worker + 1) / worker_count;
+            std::lock_guard<std::mutex> queue_lock(queues_[worker]->mutex);
+            for (std::size_t i = begin; i < end; i++) queues_[worker]->tasks.push_back(i);
+        }
+        task_ = &task;
+        busy_workers_ = threads_.size();
+        batch_++;
+    }
+    batch_started_.notify_all();
+
+    work_(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    batch_finished_.wait(lock, [this] { return busy_workers_ == 0; });
+    task_ = nullptr;
+}
+
+void WorkerPool::set_thread_count(std::size_t thread_count) {
+    if (std::max<std::size_t>(1, thread_count) == get_thread_count()) return;
+    stop_();
+    start_(thread_count);
+}
+
+std::size_t WorkerPool::get_thread_count() const noexcept { return queues_.size(); }
+
+std::size_t WorkerPool::default_thread_count() noexcept {
+    if (!FLOW_THREADS) return 1;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void WorkerPool::start_(std::size_t thread_count) {
+    thread_count = FLOW_THREADS ? std::max<std::size_t>(1, thread_count) : 1;
+
+    // Workers started by set_thread_count must not take the last batch for a new one
+    std::size_t batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = false;
+        batch = batch_;
+    }
+    for (std::size_t worker = 0; worker < thread_count; worker++) queues_.push_back(std::make_unique<Queue>());
+    for (std::size_t worker = 1; worker < thread_count; worker++)
+        threads_.emplace_back(&WorkerPool::worker_loop_, this, worker, batch);
+}
+
+void WorkerPool::stop_() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    batch_started_.notify_all();
+    for (std::thread &thread : threads_) thread.join();
+    threads_.clear();
+    queues_.clear();
+}
+
+void WorkerPool::worker_loop_(std::size_t worker, std::size_t seen_batch) {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            batch_started_.wait(lock, [this, seen_batch] { return stopping_ || batch_ != seen_batch; });
+            if (stopping_) return;
+            seen_batch = batch_;
+        }
+
+        work_(worker);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_workers_ == 0) batch_finished_.notify_one();
+    }
+}
+
+void WorkerPool::work_(std::size_t worker) {
+    std::size_t task;
+    while (pop_(worker, task) || steal_(worker, task)) (*task_)(task, worker);
+}
+
+bool WorkerPool::pop_(std::size_t worker, std::size_t &task) {
+    Queue &queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkerPool::steal_(std::size_t worker, std::size_t &task) {
+    const std::size_t worker_count = queues_.size();
+    for (std::size_t offset = 1; offset < worker_count; offset++) {
+        Queue &victim = *queues_[(worker + offset) % worker_count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,65 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef FLOW_THREADS
+#define FLOW_THREADS 1
+#endif
+
+// Runs batches of independent tasks on a fixed set of threads.
+// Every worker owns a deque of task indices and steals from the others once its own deque is empty,
+// so a few expensive tasks don't leave the rest of the pool idle.
+class WorkerPool {
+   public:
+    using Task = std::function<void(std::size_t task, std::size_t worker)>;
+
+    explicit WorkerPool(std::size_t thread_count = default_thread_count());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    // Runs task(0..task_count-1) and returns once all of them are done.
+    // The calling thread works as worker 0.
+    void run(std::size_t task_count, const Task &task);
+
+    void set_thread_count(std::size_t thread_count);
+    std::size_t get_thread_count() const noexcept;
+
+    static std::size_t default_thread_count() noexcept;
+
+   private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::vector<std::thread> threads_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+
+    std::mutex mutex_;
+    std::condition_variable batch_started_;
+    std::condition_variable batch_finished_;
+    const Task *task_ = nullptr;
+    std::size_t batch_ = 0;
+    std::size_t busy_workers_ = 0;
+    bool stopping_ = false;
+
+    void start_(std::size_t thread_count);
+    void stop_();
+    void worker_loop_(std::size_t worker, std::size_t seen_batch);
+    void work_(std::size_t worker);
+    bool pop_(std::size_t worker, std::size_t &task);
+    bool steal_(std::size_t worker, std::size_t &task);
+};
+
+#endif
@@ -0,0 +1,232 @@
+// Batch atlas of Julia sets over a grid of c values, for picking keyframes of the animation path.
+// Every thumbnail is rendered by the same renderer as the app, and the thumbnails are scheduled on a work-stealing
+// worker pool, one renderer per worker, so the atlas scales with the number of cores.
+// Writes the thumbnails as one mosaic, a binary PPM whose top left thumbnail has the smallest real and the largest
+// imaginary part of c, band by band of thumbnail rows so the mosaic is never held in memory as a whole.
+// With --index it also writes the statistics of every c, in the native byte order:
+//   header   "FLOWATLS", int32 columns, rows, size, max_iterations, formula, float c_min real, imag, c_max real, imag
+//   records  columns * rows, row by row from the top: float c real, c imag, interior fraction, mean escape count
+// The mean escape count is the mean smooth escape iteration of the cells that escaped, 0 when none did.
+//
+//   fractal_atlas --output PATH [--index PATH] [--columns N] [--rows N] [--size S] [--c-min RE,IM] [--c-max RE,IM]
+//                 [--iterations N] [--threads N] [--formula julia|julia_cubic]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../FractalRenderer/FractalRenderer.hpp"
+#include "../Palette/Palette.hpp"
+
+namespace {
+
+struct Options {
+    std::string output;
+    std::string index;
+    int columns = 32;
+    int rows = 32;
+    int size = 64;
+    float c_min_real = -2.0f;
+    float c_min_imag = -1.25f;
+    float c_max_real = 0.5f;
+    float c_max_imag = 1.25f;
+    int max_iterations = 100;
+    std::size_t threads = WorkerPool::default_thread_count();
+    FractalRenderer::Formula formula = FractalRenderer::julia;
+};
+
+struct Record {
+    float c_real;
+    float c_imag;
+    float interior_fraction;
+    float mean_escape_count;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s --output PATH [--index PATH] [--columns N] [--rows N] [--size S] [--c-min RE,IM] "
+                 "[--c-max RE,IM] [--iterations N] [--threads N] [--formula julia|julia_cubic]\n",
+                 program);
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--index" && has_value) {
+            options.index = argv[++i];
+        } else if (arg == "--columns" && has_value) {
+            options.columns = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rows" && has_value) {
+            options.rows = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--size" && has_value) {
+            // the mirrored default view needs an even width
+            options.size = std::max(8, std::atoi(argv[++i]) / 2 * 2);
+        } else if (arg == "--c-min" && has_value) {
+            if (std::sscanf(argv[++i], "%f,%f", &options.c_min_real, &options.c_min_imag) != 2) return false;
+        } else if (arg == "--c-max" && has_value) {
+            if (std::sscanf(argv[++i], "%f,%f", &options.c_max_real, &options.c_max_imag) != 2) return false;
+        } else if (arg == "--iterations" && has_value) {
+            options.max_iterations = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--formula" && has_value) {
+            if (!FractalRenderer::find_formula(argv[++i], options.formula)) return false;
+            // c is the same for every cell only in the Julia formulas
+            if (options.formula != FractalRenderer::julia && options.formula != FractalRenderer::julia_cubic)
+                return false;
+        } else {
+            return false;
+        }
+    }
+
+    return !options.output.empty();
+}
+
+// c at the center of the thumbnail's share of the range, the imaginary part decreasing downwards
+void thumbnail_c(const Options &options, int column, int row, float &c_real, float &c_imag) {
+    c_real = options.c_min_real + (options.c_max_real - options.c_min_real) * (column + 0.5f) / options.columns;
+    c_imag = options.c_max_imag - (options.c_max_imag - options.c_min_imag) * (row + 0.5f) / options.rows;
+}
+
+// A mirrored grid is point symmetric, so its half has the statistics of the whole image
+void measure(const Grid &grid, int max_iterations, Record &record) {
+    std::size_t interior = 0;
+    double escape_sum = 0.0;
+    for (int y = 0; y < grid.height(); y++) {
+        const float *row = grid.row(y);
+        for (int x = 0; x < grid.width(); x++) {
+            if (row[x] == 1.0f)
+                interior++;
+            else
+                escape_sum += row[x];
+        }
+    }
+
+    const std::size_t cells = static_cast<std::size_t>(grid.width()) * grid.height();
+    const std::size_t escaped = cells - interior;
+    record.interior_fraction = static_cast<float>(interior) / cells;
+    record.mean_escape_count = escaped ? static_cast<float>(escape_sum / escaped * max_iterations) : 0.0f;
+}
+
+// Reorders ARGB8888 pixels into R, G, B bytes
+bool write_ppm_rows(std::FILE *file, const std::vector<std::uint32_t> &pixels, std::vector<std::uint8_t> &bytes) {
+    bytes.resize(pixels.size() * 3);
+    for (std::size_t i = 0; i < pixels.size(); i++) {
+        const std::uint32_t pixel = pixels[i];
+        bytes[3 * i] = static_cast<std::uint8_t>(pixel >> 16);
+        bytes[3 * i + 1] = static_cast<std::uint8_t>(pixel >> 8);
+        bytes[3 * i + 2] = static_cast<std::uint8_t>(pixel);
+    }
+    return std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+}
+
+bool write_index(const Options &options, const std::vector<Record> &records) {
+    std::FILE *file = std::fopen(options.index.c_str(), "wb");
+    if (!file) return false;
+
+    const std::int32_t header[] = {options.columns, options.rows, options.size, options.max_iterations,
+                                   static_cast<std::int32_t>(options.formula)};
+    const float range[] = {options.c_min_real, options.c_min_imag, options.c_max_real, options.c_max_imag};
+    bool written = std::fwrite("FLOWATLS", 1, 8, file) == 8;
+    written = written && std::fwrite(header, sizeof(header), 1, file) == 1;
+    written = written && std::fwrite(range, sizeof(range), 1, file) == 1;
+    for (const Record &record : records) {
+        const float values[] = {record.c_real, record.c_imag, record.interior_fraction, record.mean_escape_count};
+        written = written && std::fwrite(values, sizeof(values), 1, file) == 1;
+    }
+    return std::fclose(file) == 0 && written;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::FILE *file = std::fopen(options.output.c_str(), "wb");
+    if (!file) {
+        std::fprintf(stderr, "could not open %s for writing\n", options.output.c_str());
+        return 1;
+    }
+
+    // Each worker renders whole thumbnails on a renderer of its own with no threads; thumbnails far outnumber the
+    // workers, so stealing them balances the load without splitting a thumbnail across workers
+    WorkerPool pool(options.threads);
+    std::vector<std::unique_ptr<FractalRenderer>> renderers;
+    for (std::size_t worker = 0; worker < pool.get_thread_count(); worker++) {
+        auto fractal = std::make_unique<FractalRenderer>();
+        fractal->set_thread_count(1);
+        fractal->set_resolution(options.size);
+        fractal->set_max_iterations(options.max_iterations);
+        fractal->set_formula(options.formula);
+        renderers.push_back(std::move(fractal));
+    }
+
+    const Palette palette;
+    const int width = options.columns * options.size;
+    const int height = options.rows * options.size;
+    bool written = std::fprintf(file, "P6\n%d %d\n255\n", width, height) > 0;
+
+    // bands of thumbnail rows with a few thumbnails per worker, so the pool never runs dry at the end of a band
+    const int band_rows = std::min<int>(
+        options.rows, std::max<std::size_t>(1, (4 * pool.get_thread_count() + options.columns - 1) / options.columns));
+    std::vector<std::uint32_t> band(static_cast<std::size_t>(width) * band_rows * options.size);
+    std::vector<std::uint8_t> bytes;
+    std::vector<Record> records(static_cast<std::size_t>(options.columns) * options.rows);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int first_row = 0; first_row < options.rows && written; first_row += band_rows) {
+        const int rows = std::min(band_rows, options.rows - first_row);
+        pool.run(static_cast<std::size_t>(rows) * options.columns, [&](std::size_t task, std::size_t worker) {
+            const int column = static_cast<int>(task % options.columns);
+            const int row = first_row + static_cast<int>(task / options.columns);
+            Record &record = records[static_cast<std::size_t>(row) * options.columns + column];
+            thumbnail_c(options, column, row, record.c_real, record.c_imag);
+
+            FractalRenderer &fractal = *renderers[worker];
+            fractal.set_c(record.c_real, record.c_imag);
+            fractal.render();
+            measure(fractal.grid(), options.max_iterations, record);
+
+            std::uint32_t *pixels = band.data() + static_cast<std::size_t>(row - first_row) * options.size * width +
+                                    static_cast<std::size_t>(column) * options.size;
+            palette.map_grid(fractal.grid(), fractal.is_mirrored(), pixels, width);
+        });
+
+        band.resize(static_cast<std::size_t>(width) * rows * options.size);
+        written = write_ppm_rows(file, band, bytes);
+    }
+    const double total_ms = elapsed_ms(start);
+
+    if (std::fclose(file) != 0 || !written) {
+        std::fprintf(stderr, "could not write to %s\n", options.output.c_str());
+        return 1;
+    }
+    if (!options.index.empty() && !write_index(options, records)) {
+        std::fprintf(stderr, "could not write to %s\n", options.index.c_str());
+        return 1;
+    }
+
+    std::fprintf(stderr,
+                 "%zu thumbnails of %dx%d in %.2f s: %.1f thumbnails/s, %.1f Mpixels/s (threads: %zu, kernels: %s)\n",
+                 records.size(), options.size, options.size, total_ms / 1000.0, records.size() * 1000.0 / total_ms,
+                 static_cast<double>(width) * height / total_ms / 1000.0, pool.get_thread_count(),
+                 renderers.front()->get_kernel_isa());
+    return 0;
+}
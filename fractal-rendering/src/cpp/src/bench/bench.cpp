@@ -0,0 +1,213 @@
+// Headless benchmark of the Julia set compute path.
+// Renders a fixed number of frames for every combination of resolution and c, with no window or browser involved,
+// and prints frame time percentiles, time per grid cell and iteration counts.
+// --isa renders with the kernels of another vector instruction set than the widest supported one. --kernels instead
+// measures the raw throughput of the kernel of every supported set, on one thread and at exactly --iterations per
+// point, in pixels per second.
+//
+//   fractal_bench [--frames N] [--warmup N] [--resolution R]... [--c RE,IM]... [--threads N] [--iterations N]
+//                 [--no-periodicity] [--view X,Y,HALF_HEIGHT] [--formula NAME] [--isa NAME] [--kernels]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../FractalRenderer/FractalRenderer.hpp"
+
+namespace {
+
+struct Options {
+    int frames = 100;
+    int warmup = 10;
+    int max_iterations = 50;
+    std::size_t threads = WorkerPool::default_thread_count();
+    bool periodicity = true;
+    std::vector<int> resolutions;
+    std::vector<std::pair<float, float>> cs;
+    FractalRenderer::View view;
+    FractalRenderer::Formula formula = FractalRenderer::julia;
+    std::string isa;
+    bool kernels = false;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s [--frames N] [--warmup N] [--resolution R]... [--c RE,IM]... [--threads N] "
+                 "[--iterations N] [--no-periodicity] [--view X,Y,HALF_HEIGHT] [--formula NAME] "
+                 "[--isa NAME] [--kernels]\n",
+                 program);
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--no-periodicity") {
+            options.periodicity = false;
+        } else if (arg == "--kernels") {
+            options.kernels = true;
+        } else if (arg == "--frames" && has_value) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && has_value) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--resolution" && has_value) {
+            options.resolutions.push_back(std::max(4, std::atoi(argv[++i])));
+        } else if (arg == "--iterations" && has_value) {
+            options.max_iterations = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--c" && has_value) {
+            float c_real, c_imag;
+            if (std::sscanf(argv[++i], "%f,%f", &c_real, &c_imag) != 2) return false;
+            options.cs.emplace_back(c_real, c_imag);
+        } else if (arg == "--view" && has_value) {
+            double x, y, half_height;
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf", &x, &y, &half_height) != 3) return false;
+            options.view = {x, y, half_height};
+        } else if (arg == "--formula" && has_value) {
+            if (!FractalRenderer::find_formula(argv[++i], options.formula)) return false;
+        } else if (arg == "--isa" && has_value) {
+            options.isa = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    if (options.resolutions.empty()) options.resolutions = {600, 1200};
+    // points of the app animation with very different amounts of work
+    if (options.cs.empty()) options.cs = {{-0.8f, 0.156f}, {-0.4f, 0.6f}, {0.285f, 0.01f}, {-0.835f, -0.2321f}};
+    return true;
+}
+
+// nearest-rank percentile of sorted values
+double percentile(const std::vector<double> &sorted, double p) {
+    const std::size_t rank = static_cast<std::size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+// Runs the quadratic Julia kernel of every supported set with c = 0 on points spread over the disk of radius 0.9,
+// whose orbits converge to 0 without ever escaping, so with the cycle detection off every lane runs exactly
+// max_iterations. Each set takes the best of frames passes over the points.
+void benchmark_kernels(const Options &options) {
+    constexpr int points = 1 << 16;
+    std::vector<float> xs(points);
+    std::vector<float> ys(points);
+    for (int i = 0; i < points; i++) {
+        const float radius = 0.9f * std::sqrt((i + 0.5f) / points);
+        const float angle = 2.39996323f * i;
+        xs[i] = radius * std::cos(angle);
+        ys[i] = radius * std::sin(angle);
+    }
+
+    float values[kernels::max_lanes];
+    std::int32_t iterations[kernels::max_lanes];
+    std::int32_t periodic_iterations[kernels::max_lanes];
+    const kernels::EscapeParams params = {0.0f, 0.0f, options.max_iterations, 0.0f};
+
+    std::printf("kernels: %d points, iterations: %d, passes: %d, 1 thread\n", points, options.max_iterations,
+                options.frames);
+    std::printf("%10s %6s %9s %12s %12s %8s\n", "isa", "lanes", "best ms", "Mpixels/s", "Giters/s", "speedup");
+
+    // the baseline set comes last, so its time is known only after the others; the first pass only warms up
+    const std::vector<const kernels::KernelSet *> sets = kernels::supported_kernel_sets();
+    std::vector<double> best_ms(sets.size());
+    for (std::size_t s = 0; s < sets.size(); s++) {
+        const kernels::Batch batch = sets[s]->batches[FractalRenderer::julia];
+        for (int pass = 0; pass <= options.frames; pass++) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < points; i += sets[s]->lanes)
+                batch(params, &xs[i], &ys[i], values, iterations, periodic_iterations);
+            const double ms =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (pass == 1 || (pass > 1 && ms < best_ms[s])) best_ms[s] = ms;
+        }
+    }
+
+    for (std::size_t s = 0; s < sets.size(); s++) {
+        const double seconds = best_ms[s] / 1e3;
+        std::printf("%10s %6d %9.3f %12.1f %12.3f %7.2fx\n", sets[s]->isa, sets[s]->lanes, best_ms[s],
+                    points / seconds / 1e6, static_cast<double>(points) * options.max_iterations / seconds / 1e9,
+                    best_ms.back() / best_ms[s]);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (options.kernels) {
+        benchmark_kernels(options);
+        return 0;
+    }
+
+    FractalRenderer fractal;
+    if (!options.isa.empty() && !fractal.set_kernel_isa(options.isa)) {
+        std::string isas;
+        for (const std::string &isa : FractalRenderer::kernel_isas()) isas += " " + isa;
+        std::fprintf(stderr, "unsupported isa %s, this CPU runs:%s\n", options.isa.c_str(), isas.c_str());
+        return 1;
+    }
+    fractal.set_thread_count(options.threads);
+    fractal.set_periodicity_check(options.periodicity);
+    fractal.set_max_iterations(options.max_iterations);
+    fractal.set_formula(options.formula);
+    fractal.set_view(options.view);
+
+    std::printf("kernels: %s, threads: %zu, iterations: %d, frames: %d (+%d warmup), periodicity: %s\n",
+                fractal.get_kernel_isa(), fractal.get_thread_count(), options.max_iterations, options.frames,
+                options.warmup, options.periodicity ? "on" : "off");
+    std::printf("formula: %s, view: %.17g, %.17g, half height %g\n", FractalRenderer::formula_name(options.formula),
+                static_cast<double>(options.view.center_x), static_cast<double>(options.view.center_y),
+                fractal.get_view().half_height);
+    std::printf("%10s %22s %9s %9s %9s %9s %10s %14s %14s\n", "resolution", "c", "mean ms", "p50 ms", "p90 ms",
+                "p99 ms", "ns/cell", "iters/frame", "saved/frame");
+
+    for (const int resolution : options.resolutions) {
+        fractal.set_resolution(resolution);
+        const double cells = static_cast<double>(fractal.grid().width()) * fractal.grid().height();
+
+        for (const auto &[c_real, c_imag] : options.cs) {
+            fractal.set_c(c_real, c_imag);
+            for (int frame = 0; frame < options.warmup; frame++) fractal.render();
+
+            std::vector<double> frame_ms;
+            frame_ms.reserve(options.frames);
+            std::uint64_t iterations = 0;
+            std::uint64_t saved_iterations = 0;
+            for (int frame = 0; frame < options.frames; frame++) {
+                const auto start = std::chrono::steady_clock::now();
+                fractal.render();
+                const auto end = std::chrono::steady_clock::now();
+
+                frame_ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+                iterations += fractal.get_iterations();
+                saved_iterations += fractal.get_saved_iterations();
+            }
+
+            double total_ms = 0.0;
+            for (const double ms : frame_ms) total_ms += ms;
+            const double mean_ms = total_ms / options.frames;
+            std::sort(frame_ms.begin(), frame_ms.end());
+
+            char c[32];
+            std::snprintf(c, sizeof(c), "%+.4f%+.4fi", c_real, c_imag);
+            std::printf("%10d %22s %9.3f %9.3f %9.3f %9.3f %10.3f %14llu %14llu\n", resolution, c, mean_ms,
+                        percentile(frame_ms, 50), percentile(frame_ms, 90), percentile(frame_ms, 99),
+                        mean_ms * 1e6 / cells, static_cast<unsigned long long>(iterations / options.frames),
+                        static_cast<unsigned long long>(saved_iterations / options.frames));
+        }
+    }
+
+    return 0;
+}
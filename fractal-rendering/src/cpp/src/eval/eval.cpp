@@ -0,0 +1,202 @@
+// Accuracy against speed of the fast render path.
+// Renders every keyframe c of the app's animation path twice: once as the reference, with every cell computed and no
+// periodicity check, and once through the subdivision the app uses, for each minimum rectangle size. Prints the time,
+// the iteration count and the error of every frame: the max and mean absolute difference from the reference and the
+// cells whose interior classification differs from it.
+// With --max-error or --max-misclassified it exits with status 2 when any frame exceeds them, to catch regressions.
+//
+//   fractal_eval [--resolution R] [--iterations N] [--threads N] [--frames N] [--min-size N]... [--no-periodicity]
+//                [--view X,Y,HALF_HEIGHT] [--formula NAME] [--max-error E] [--max-misclassified N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../CPath/CPath.hpp"
+#include "../FractalRenderer/FractalRenderer.hpp"
+
+namespace {
+
+struct Options {
+    int resolution = 600;
+    int max_iterations = 50;
+    std::size_t threads = WorkerPool::default_thread_count();
+    int frames = 5;
+    std::vector<int> min_sizes;
+    bool periodicity = true;
+    FractalRenderer::View view;
+    FractalRenderer::Formula formula = FractalRenderer::julia;
+    double max_error = -1.0;
+    long long max_misclassified = -1;
+};
+
+// A render of one keyframe, timed over the best of a few repeats to keep scheduling noise out of the comparison
+struct Render {
+    Grid grid;
+    double ms = 0.0;
+    std::uint64_t iterations = 0;
+};
+
+struct Error {
+    double max = 0.0;
+    double mean = 0.0;
+    long long misclassified = 0;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s [--resolution R] [--iterations N] [--threads N] [--frames N] [--min-size N]... "
+                 "[--no-periodicity] [--view X,Y,HALF_HEIGHT] [--formula NAME] [--max-error E] "
+                 "[--max-misclassified N]\n",
+                 program);
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--no-periodicity") {
+            options.periodicity = false;
+        } else if (arg == "--resolution" && has_value) {
+            options.resolution = std::max(4, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && has_value) {
+            options.max_iterations = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--frames" && has_value) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-size" && has_value) {
+            options.min_sizes.push_back(std::max(2, std::atoi(argv[++i])));
+        } else if (arg == "--view" && has_value) {
+            double x, y, half_height;
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf", &x, &y, &half_height) != 3) return false;
+            options.view = {x, y, half_height};
+        } else if (arg == "--formula" && has_value) {
+            if (!FractalRenderer::find_formula(argv[++i], options.formula)) return false;
+        } else if (arg == "--max-error" && has_value) {
+            options.max_error = std::atof(argv[++i]);
+        } else if (arg == "--max-misclassified" && has_value) {
+            options.max_misclassified = std::atoll(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+
+    if (options.min_sizes.empty()) options.min_sizes = {2, 4, 8, 16};
+    return true;
+}
+
+void render(FractalRenderer &fractal, int frames, Render &result) {
+    result.ms = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        const auto start = std::chrono::steady_clock::now();
+        fractal.render();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.ms = frame ? std::min(result.ms, ms) : ms;
+    }
+    result.iterations = fractal.get_iterations();
+    result.grid.copy_from(fractal.grid());
+}
+
+bool exceeds(const Options &options, const Error &error) {
+    return (options.max_error >= 0.0 && error.max > options.max_error) ||
+           (options.max_misclassified >= 0 && error.misclassified > options.max_misclassified);
+}
+
+// Interior cells are the ones that never escaped, exactly 1
+Error compare(const Grid &reference, const Grid &grid) {
+    Error error;
+    double sum = 0.0;
+    for (int y = 0; y < reference.height(); y++) {
+        const float *expected = reference.row(y);
+        const float *actual = grid.row(y);
+        for (int x = 0; x < reference.width(); x++) {
+            const double difference = std::abs(static_cast<double>(expected[x]) - actual[x]);
+            error.max = std::max(error.max, difference);
+            sum += difference;
+            if ((expected[x] == 1.0f) != (actual[x] == 1.0f)) error.misclassified++;
+        }
+    }
+    error.mean = sum / (static_cast<double>(reference.width()) * reference.height());
+    return error;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    FractalRenderer fractal;
+    fractal.set_thread_count(options.threads);
+    fractal.set_max_iterations(options.max_iterations);
+    fractal.set_formula(options.formula);
+    fractal.set_view(options.view);
+    fractal.set_resolution(options.resolution);
+
+    // the app's path is closed, so its last point repeats the first
+    std::vector<CPath::Point> keyframes = CPath().points();
+    if (keyframes.size() > 1 && keyframes.front() == keyframes.back()) keyframes.pop_back();
+
+    std::printf("kernels: %s, threads: %zu, iterations: %d, resolution: %d, periodicity: %s, formula: %s\n",
+                fractal.get_kernel_isa(), fractal.get_thread_count(), options.max_iterations, options.resolution,
+                options.periodicity ? "on" : "off", FractalRenderer::formula_name(options.formula));
+
+    std::vector<Render> references(keyframes.size());
+    fractal.set_subdivision(false);
+    fractal.set_periodicity_check(false);
+    for (std::size_t i = 0; i < keyframes.size(); i++) {
+        fractal.set_c(keyframes[i].first, keyframes[i].second);
+        render(fractal, options.frames, references[i]);
+    }
+
+    fractal.set_subdivision(true);
+    fractal.set_periodicity_check(options.periodicity);
+    bool exceeded = false;
+    Render fast;
+    for (const int min_size : options.min_sizes) {
+        fractal.set_min_rectangle_size(min_size);
+        std::printf("\nmin rectangle size %d\n", min_size);
+        std::printf("%22s %9s %9s %8s %12s %12s %10s %10s %13s\n", "c", "ref ms", "fast ms", "speedup", "ref iters",
+                    "fast iters", "max err", "mean err", "misclassified");
+
+        double reference_ms = 0.0, fast_ms = 0.0, mean_error = 0.0;
+        Error worst;
+        for (std::size_t i = 0; i < keyframes.size(); i++) {
+            fractal.set_c(keyframes[i].first, keyframes[i].second);
+            render(fractal, options.frames, fast);
+            const Error error = compare(references[i].grid, fast.grid);
+
+            reference_ms += references[i].ms;
+            fast_ms += fast.ms;
+            mean_error += error.mean;
+            worst.max = std::max(worst.max, error.max);
+            worst.misclassified += error.misclassified;
+            if (exceeds(options, error)) exceeded = true;
+
+            char c[32];
+            std::snprintf(c, sizeof(c), "%+.4f%+.4fi", keyframes[i].first, keyframes[i].second);
+            std::printf("%22s %9.3f %9.3f %7.2fx %12llu %12llu %10.6f %10.6f %13lld\n", c, references[i].ms, fast.ms,
+                        references[i].ms / fast.ms, static_cast<unsigned long long>(references[i].iterations),
+                        static_cast<unsigned long long>(fast.iterations), error.max, error.mean, error.misclassified);
+        }
+
+        std::printf("%22s %9.3f %9.3f %7.2fx %12s %12s %10.6f %10.6f %13lld\n", "all", reference_ms, fast_ms,
+                    reference_ms / fast_ms, "", "", worst.max, mean_error / keyframes.size(), worst.misclassified);
+    }
+
+    if (exceeded) {
+        std::fprintf(stderr, "error limits exceeded\n");
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+// Headless export of the c animation loop to a video stream.
+// Steps the animation deterministically, renders every frame at the given resolution and streams it to a file (or
+// stdout with -) as Y4M (YUV 4:2:0) or raw RGBA, so the animation is never held in memory as a whole.
+// A writer thread converts and writes frame N while frame N+1 is rendered; the two are connected by bounded queues of
+// recycled frame buffers, which cap the memory at a few frames.
+//
+//   fractal_export --output PATH [--format y4m|rgba] [--frames N] [--fps N] [--resolution R] [--iterations N]
+//                  [--threads N] [--queue N] [--view X,Y,HALF_HEIGHT] [--formula NAME]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../BoundedQueue/BoundedQueue.hpp"
+#include "../CPath/CPath.hpp"
+#include "../FractalRenderer/FractalRenderer.hpp"
+#include "../Palette/Palette.hpp"
+
+namespace {
+
+enum class Format { y4m, rgba };
+
+struct Options {
+    std::string output;
+    Format format = Format::y4m;
+    bool format_given = false;
+    int frames = 600;
+    int fps = 30;
+    int resolution = 1080;
+    int max_iterations = 100;
+    std::size_t threads = WorkerPool::default_thread_count();
+    std::size_t queue = 4;
+    FractalRenderer::View view;
+    FractalRenderer::Formula formula = FractalRenderer::julia;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s --output PATH [--format y4m|rgba] [--frames N] [--fps N] [--resolution R] "
+                 "[--iterations N] [--threads N] [--queue N] [--view X,Y,HALF_HEIGHT] [--formula NAME]\n",
+                 program);
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--output" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--format" && has_value) {
+            const std::string format = argv[++i];
+            if (format == "y4m")
+                options.format = Format::y4m;
+            else if (format == "rgba")
+                options.format = Format::rgba;
+            else
+                return false;
+            options.format_given = true;
+        } else if (arg == "--frames" && has_value) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--fps" && has_value) {
+            options.fps = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--resolution" && has_value) {
+            // the mirrored default view needs an even width
+            options.resolution = std::max(4, std::atoi(argv[++i]) / 2 * 2);
+        } else if (arg == "--iterations" && has_value) {
+            options.max_iterations = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--queue" && has_value) {
+            options.queue = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--view" && has_value) {
+            double x, y, half_height;
+            if (std::sscanf(argv[++i], "%lf,%lf,%lf", &x, &y, &half_height) != 3) return false;
+            options.view = {x, y, half_height};
+        } else if (arg == "--formula" && has_value) {
+            if (!FractalRenderer::find_formula(argv[++i], options.formula)) return false;
+        } else {
+            return false;
+        }
+    }
+
+    if (options.output.empty()) return false;
+    if (!options.format_given && options.output.size() >= 5 &&
+        options.output.compare(options.output.size() - 5, 5, ".rgba") == 0)
+        options.format = Format::rgba;
+    return true;
+}
+
+// Converts ARGB8888 pixels to planar YUV 4:2:0 with BT.601 studio range, averaging the chroma of 2x2 blocks
+class Y4mEncoder {
+   public:
+    Y4mEncoder(int width, int height)
+        : width_(width),
+          height_(height),
+          chroma_width_((width + 1) / 2),
+          chroma_height_((height + 1) / 2),
+          y_(static_cast<std::size_t>(width) * height),
+          u_(static_cast<std::size_t>(chroma_width_) * chroma_height_),
+          v_(u_.size()) {}
+
+    bool write_header(std::FILE *file, int fps) const {
+        return std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width_, height_, fps) > 0;
+    }
+
+    bool write_frame(std::FILE *file, const std::vector<std::uint32_t> &pixels) {
+        for (int y = 0; y < height_; y++) {
+            const std::uint32_t *row = pixels.data() + static_cast<std::size_t>(y) * width_;
+            std::uint8_t *luma = y_.data() + static_cast<std::size_t>(y) * width_;
+            for (int x = 0; x < width_; x++) {
+                const int r = red(row[x]), g = green(row[x]), b = blue(row[x]);
+                luma[x] = static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            }
+        }
+
+        for (int y = 0; y < chroma_height_; y++) {
+            for (int x = 0; x < chroma_width_; x++) {
+                int r = 0, g = 0, b = 0, count = 0;
+                for (int j = 2 * y; j < std::min(2 * y + 2, height_); j++) {
+                    for (int i = 2 * x; i < std::min(2 * x + 2, width_); i++) {
+                        const std::uint32_t pixel = pixels[static_cast<std::size_t>(j) * width_ + i];
+                        r += red(pixel);
+                        g += green(pixel);
+                        b += blue(pixel);
+                        count++;
+                    }
+                }
+                r /= count;
+                g /= count;
+                b /= count;
+                const std::size_t index = static_cast<std::size_t>(y) * chroma_width_ + x;
+                u_[index] = static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                v_[index] = static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+
+        return std::fputs("FRAME\n", file) >= 0 && std::fwrite(y_.data(), 1, y_.size(), file) == y_.size() &&
+               std::fwrite(u_.data(), 1, u_.size(), file) == u_.size() &&
+               std::fwrite(v_.data(), 1, v_.size(), file) == v_.size();
+    }
+
+   private:
+    int width_;
+    int height_;
+    int chroma_width_;
+    int chroma_height_;
+    std::vector<std::uint8_t> y_;
+    std::vector<std::uint8_t> u_;
+    std::vector<std::uint8_t> v_;
+
+    static int red(std::uint32_t pixel) noexcept { return (pixel >> 16) & 0xFF; }
+    static int green(std::uint32_t pixel) noexcept { return (pixel >> 8) & 0xFF; }
+    static int blue(std::uint32_t pixel) noexcept { return pixel & 0xFF; }
+};
+
+// Reorders ARGB8888 pixels into R, G, B, A bytes
+bool write_rgba_frame(std::FILE *file, const std::vector<std::uint32_t> &pixels, std::vector<std::uint8_t> &bytes) {
+    bytes.resize(pixels.size() * 4);
+    for (std::size_t i = 0; i < pixels.size(); i++) {
+        const std::uint32_t pixel = pixels[i];
+        bytes[4 * i] = static_cast<std::uint8_t>(pixel >> 16);
+        bytes[4 * i + 1] = static_cast<std::uint8_t>(pixel >> 8);
+        bytes[4 * i + 2] = static_cast<std::uint8_t>(pixel);
+        bytes[4 * i + 3] = static_cast<std::uint8_t>(pixel >> 24);
+    }
+    return std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::FILE *file = options.output == "-" ? stdout : std::fopen(options.output.c_str(), "wb");
+    if (!file) {
+        std::fprintf(stderr, "could not open %s for writing\n", options.output.c_str());
+        return 1;
+    }
+
+    FractalRenderer fractal;
+    fractal.set_thread_count(options.threads);
+    fractal.set_resolution(options.resolution);
+    fractal.set_max_iterations(options.max_iterations);
+    fractal.set_formula(options.formula);
+    fractal.set_view(options.view);
+
+    const CPath c_path;
+    const Palette palette;
+    const int width = fractal.is_mirrored() ? 2 * fractal.grid().width() : fractal.grid().width();
+    const int height = fractal.grid().height();
+
+    Y4mEncoder encoder(width, height);
+    if (options.format == Format::y4m && !encoder.write_header(file, options.fps)) {
+        std::fprintf(stderr, "could not write to %s\n", options.output.c_str());
+        return 1;
+    }
+
+    // Buffers circulate from free_frames to the renderer, through ready_frames to the writer and back, so there are
+    // never more than queue + 2 frames in memory: queue waiting, one being rendered and one being written
+    using Frame = std::vector<std::uint32_t>;
+    BoundedQueue<Frame> ready_frames(options.queue);
+    BoundedQueue<Frame> free_frames(options.queue + 2);
+    for (std::size_t i = 0; i < options.queue + 2; i++)
+        free_frames.push(Frame(static_cast<std::size_t>(width) * height));
+
+    double write_ms = 0.0;
+    bool write_failed = false;
+    std::thread writer([&] {
+        std::vector<std::uint8_t> bytes;
+        while (std::optional<Frame> frame = ready_frames.pop()) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool written = options.format == Format::y4m ? encoder.write_frame(file, *frame)
+                                                               : write_rgba_frame(file, *frame, bytes);
+            write_ms += elapsed_ms(start);
+            if (!written) {
+                write_failed = true;
+                ready_frames.close();
+                free_frames.close();
+                return;
+            }
+            free_frames.push(std::move(*frame));
+        }
+    });
+
+    const auto export_start = std::chrono::steady_clock::now();
+    double render_ms = 0.0;
+    int rendered = 0;
+    for (; rendered < options.frames; rendered++) {
+        std::optional<Frame> frame = free_frames.pop();
+        if (!frame) break;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto [c_real, c_imag] = c_path.at(static_cast<float>(rendered) / options.frames);
+        fractal.set_c(c_real, c_imag);
+        fractal.render();
+        palette.map_grid(fractal.grid(), fractal.is_mirrored(), frame->data(), width);
+        render_ms += elapsed_ms(start);
+
+        if (!ready_frames.push(std::move(*frame))) break;
+    }
+    ready_frames.close();
+    writer.join();
+    const double total_ms = elapsed_ms(export_start);
+
+    const bool closed = file == stdout ? std::fflush(file) == 0 : std::fclose(file) == 0;
+    if (write_failed || !closed) {
+        std::fprintf(stderr, "could not write to %s\n", options.output.c_str());
+        return 1;
+    }
+
+    std::fprintf(stderr,
+                 "%d frames of %dx%d in %.2f s: %.2f frames/s (render %.2f ms/frame, write %.2f ms/frame, "
+                 "threads: %zu, kernels: %s)\n",
+                 rendered, width, height, total_ms / 1000.0, rendered * 1000.0 / total_ms,
+                 render_ms / std::max(1, rendered), write_ms / std::max(1, rendered), fractal.get_thread_count(),
+                 fractal.get_kernel_isa());
+    return 0;
+}
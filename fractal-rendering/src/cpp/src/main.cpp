@@ -6,8 +6,6 @@
 int main() {
   srand(time(NULL));
 
-  Messenger::instance().start_listening();
-
   Application app;
 
   emscripten_set_main_loop_arg(
@@ -0,0 +1,107 @@
+#ifndef COMMAND_QUEUE_HPP
+#define COMMAND_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// A control command from the page, with a fixed layout that src/channel.ts writes directly into wasm memory.
+// The meaning of args depends on the type:
+//   threads         [count]
+//   paused          [paused]
+//   set_c           [real, imag]; pins c until animate_c
+//   animate_c       []
+//   view            [center x hi, center x lo, center y hi, center y lo, half height]
+//   reset_view      []
+//   quality         [adaptive, target frame time, min resolution, max resolution, min iterations, max iterations];
+//                   a negative value keeps the current setting
+//   palette_stop    [position, r, g, b]; collected until palette_commit
+//   palette_commit  []
+//   palette_default []
+//   formula         [FractalRenderer::Formula]
+//   frame_cache     [enabled, budget in MiB]; a negative budget keeps the current one
+//   pipelined       [enabled]
+//   seek            [progress in [0, 1)]; returns c to the animation
+//   playback_rate   [rate]; 1 is the default speed, negative plays backwards
+//   loop_range      [start, end]; an empty range or one outside [0, 1] is the whole loop
+//   record          [enabled]; records a trace of the inputs from here on (see Trace.hpp), replacing the last one
+struct Command {
+    enum Type : std::uint32_t {
+        none = 0,
+        threads,
+        paused,
+        set_c,
+        animate_c,
+        view,
+        reset_view,
+        quality,
+        palette_stop,
+        palette_commit,
+        palette_default,
+        formula,
+        frame_cache,
+        pipelined,
+        seek,
+        playback_rate,
+        loop_range,
+        record,
+    };
+
+    static constexpr int arg_count = 6;
+
+    std::uint32_t type = none;
+    std::uint32_t reserved = 0;
+    double args[arg_count] = {};
+};
+
+static_assert(sizeof(Command) == 56 && offsetof(Command, args) == 8, "Command layout is shared with channel.ts");
+
+// Lock-free single producer, single consumer ring of commands. The page is the producer and the render loop the
+// consumer; both only ever increment their own index, and the indices wrap through the power of two capacity.
+// head and tail sit on their own cache lines so the two sides do not contend for them.
+class CommandQueue {
+   public:
+    static constexpr std::uint32_t capacity = 256;
+
+    // Returns false when the queue is full
+    bool push(const Command &command) noexcept {
+        const std::uint32_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == capacity) return false;
+
+        commands_[head % capacity] = command;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false when the queue is empty
+    bool pop(Command &command) noexcept {
+        const std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+
+        command = commands_[tail % capacity];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    alignas(64) std::atomic<std::uint32_t> head_ = 0;
+    alignas(64) std::atomic<std::uint32_t> tail_ = 0;
+    alignas(64) Command commands_[capacity];
+
+    static_assert((capacity & (capacity - 1)) == 0, "indices wrap through the capacity");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free);
+
+    friend struct CommandQueueLayout;
+};
+
+// Byte offsets of the queue fields, shared with channel.ts
+struct CommandQueueLayout {
+    static constexpr std::size_t head = offsetof(CommandQueue, head_);
+    static constexpr std::size_t tail = offsetof(CommandQueue, tail_);
+    static constexpr std::size_t commands = offsetof(CommandQueue, commands_);
+};
+
+static_assert(CommandQueueLayout::head == 0 && CommandQueueLayout::tail == 64 && CommandQueueLayout::commands == 128,
+              "CommandQueue layout is shared with channel.ts");
+
+#endif
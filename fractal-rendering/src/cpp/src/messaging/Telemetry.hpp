@@ -0,0 +1,56 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "../Profiler/Profiler.hpp"
+
+// Stats for the page, with a fixed layout that src/channel.ts reads directly from wasm memory.
+// Only the render loop writes it. sequence is odd while a write is in progress, so a reader that sees the same even
+// sequence before and after copying the block got a consistent snapshot.
+struct Telemetry {
+    struct Summary {
+        double min = 0.0;
+        double mean = 0.0;
+        double p95 = 0.0;
+    };
+
+    std::atomic<std::uint32_t> sequence = 0;
+    std::uint32_t stage_count = Profiler::stage_count;
+    std::uint32_t counter_count = Profiler::counter_count;
+    std::uint32_t reserved = 0;
+
+    // drawn frames and main loop wakeups per second, and the share of the time the loop was busy
+    double frame_rate = 0.0;
+    double wakeup_rate = 0.0;
+    double cpu_load = 0.0;
+    double threads = 0.0;
+    double resolution = 0.0;
+    double max_iterations = 0.0;
+    // frames the summaries cover, 0 when there were none since the last write
+    double profile_frames = 0.0;
+    // share of the frames since the last write that came from the frame cache, and its compressed size
+    double cache_hit_rate = 0.0;
+    double cache_bytes = 0.0;
+    // position of the c animation in its loop, in [0, 1)
+    double progress = 0.0;
+    // stage summaries are in milliseconds, counter summaries per frame
+    Summary stages[Profiler::stage_count];
+    Summary counters[Profiler::counter_count];
+
+    template <typename Write>
+    void write(Write write) noexcept {
+        const std::uint32_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        write(*this);
+        sequence.store(start + 2, std::memory_order_release);
+    }
+};
+
+static_assert(offsetof(Telemetry, frame_rate) == 16 && offsetof(Telemetry, stages) == 96,
+              "Telemetry layout is shared with channel.ts");
+
+#endif
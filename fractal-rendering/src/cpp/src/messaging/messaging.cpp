@@ -1,43 +1,21 @@
 #include "messaging.hpp"
 
-void Messenger::start_listening() const noexcept {
-    emscripten_run_script(
-        "window.addEventListener('message', function(event) { Module.ccall('handleMessage', 'void', "
-        "['string'], [event.data]); });");
-}
-
-void Messenger::send_message(const std::string& message) const noexcept {
-    EM_ASM({ window.postMessage(JSON.stringify(Module.UTF8ToString($0)), '*'); }, message.c_str());
-}
-
-void Messenger::add_message(const std::string& message) noexcept { Messenger::instance().messages_.push(message); }
+CommandQueue* flow_command_queue() { return &Messenger::instance().commands(); }
 
-bool Messenger::has_message() const noexcept { return Messenger::instance().messages_.size() > 0; }
+Telemetry* flow_telemetry() { return &Messenger::instance().telemetry(); }
 
-std::string Messenger::get_message() {
-    if (!Messenger::instance().messages_.size()) throw std::runtime_error("no messages to get");
-
-    std::string message = Messenger::instance().messages_.front();
-    Messenger::instance().messages_.pop();
-    return message;
+const char* flow_stage_name(int stage) {
+    if (stage < 0 || stage >= Profiler::stage_count) return "";
+    return Profiler::stage_name(static_cast<Profiler::Stage>(stage));
 }
 
-void handleMessage(const char* message) {
-    rapidjson::Document document;
-    document.Parse(message);
-
-    if (document.HasParseError() || !document.IsObject() || !document.HasMember("to") || !document["to"].IsString() ||
-        document["to"].GetString() != std::string("cpp") || !document.HasMember("message") ||
-        !document["message"].IsObject())
-        return;
+const char* flow_counter_name(int counter) {
+    if (counter < 0 || counter >= Profiler::counter_count) return "";
+    return Profiler::counter_name(static_cast<Profiler::Counter>(counter));
+}
 
-    rapidjson::Value& message_val = document["message"];
+int flow_trace_recording() { return Messenger::instance().is_recording(); }
 
-    // convert message to string
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    message_val.Accept(writer);
+const std::uint8_t* flow_trace() { return Messenger::instance().trace().data().data(); }
 
-    std::string json_string = buffer.GetString();
-    Messenger::instance().add_message(json_string);
-}
\ No newline at end of file
+std::size_t flow_trace_size() { return Messenger::instance().trace().data().size(); }
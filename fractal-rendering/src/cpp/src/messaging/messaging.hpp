@@ -2,21 +2,28 @@
 #define MESSAGING_HPP
 
 #include <emscripten.h>
-#include <rapidjson/document.h>
-#include <rapidjson/stringbuffer.h>
-#include <rapidjson/writer.h>
 
-#include <iostream>
-#include <queue>
-#include <string>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
+#include "../Trace/Trace.hpp"
+#include "CommandQueue.hpp"
+#include "Telemetry.hpp"
+
+// Owns the command queue and the telemetry block shared with the page. Both live in static storage, so their
+// addresses in wasm memory never change, and the page finds them through the exported functions below.
+// The recorded trace grows while recording, so the page only reads it once recording stopped.
 class Messenger {
    private:
     Messenger() {}
     Messenger(const Messenger&) = delete;
     Messenger& operator=(const Messenger&) = delete;
 
-    std::queue<std::string> messages_;
+    CommandQueue commands_;
+    Telemetry telemetry_;
+    TraceWriter trace_;
+    std::atomic<bool> recording_ = false;
 
    public:
     static Messenger& instance() {
@@ -24,17 +31,28 @@ class Messenger {
         return instance;
     }
 
-    void start_listening() const noexcept;
-    void send_message(const std::string& message) const noexcept;
-    void add_message(const std::string& message) noexcept;
-
-    bool has_message() const noexcept;
-    std::string get_message();
+    CommandQueue& commands() noexcept { return commands_; }
+    Telemetry& telemetry() noexcept { return telemetry_; }
+    TraceWriter& trace() noexcept { return trace_; }
+    void set_recording(const bool& recording) noexcept { recording_ = recording; }
+    bool is_recording() const noexcept { return recording_; }
 };
 
 extern "C" {
 EMSCRIPTEN_KEEPALIVE
-void handleMessage(const char* message);
+CommandQueue* flow_command_queue();
+EMSCRIPTEN_KEEPALIVE
+Telemetry* flow_telemetry();
+EMSCRIPTEN_KEEPALIVE
+const char* flow_stage_name(int stage);
+EMSCRIPTEN_KEEPALIVE
+const char* flow_counter_name(int counter);
+EMSCRIPTEN_KEEPALIVE
+int flow_trace_recording();
+EMSCRIPTEN_KEEPALIVE
+const std::uint8_t* flow_trace();
+EMSCRIPTEN_KEEPALIVE
+std::size_t flow_trace_size();
 }
 
-#endif
\ No newline at end of file
+#endif
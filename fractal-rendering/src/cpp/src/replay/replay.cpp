@@ -0,0 +1,163 @@
+// Replays a trace the app recorded (see Trace.hpp), for repeatable before and after comparisons of renderer changes.
+// The trace drives the same Session the app runs, without a window and on a virtual clock: every tick moves the
+// animation by the delta time the app saw, however long the replay takes, and frames are rendered at the quality the
+// app picked. Prints, for every drawn frame, the virtual time, the time update and draw took, and a checksum of the
+// grid the frame showed, then a summary with a digest of all checksums. The checksums match between runs as long as
+// the rendered grids do; in pipelined mode a frame finishes at its own pace, so they can land on other frames.
+// A trace that is cut off, as by a crash while recording, is replayed up to there and exits with status 2.
+//
+//   fractal_replay --trace PATH [--threads N] [--quiet]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../Session/Session.hpp"
+#include "../Trace/Trace.hpp"
+
+namespace {
+
+struct Options {
+    std::string trace;
+    // 0 follows the thread count of the trace
+    std::size_t threads = 0;
+    bool quiet = false;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr, "usage: %s --trace PATH [--threads N] [--quiet]\n", program);
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg == "--trace" && has_value) {
+            options.trace = argv[++i];
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else {
+            return false;
+        }
+    }
+    return !options.trace.empty();
+}
+
+bool read_file(const std::string &path, std::vector<std::uint8_t> &bytes) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    std::uint8_t buffer[1 << 16];
+    std::size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + read);
+    const bool failed = std::ferror(file);
+    std::fclose(file);
+    return !failed;
+}
+
+// FNV-1a over the size and the bits of every cell, skipping the row padding
+std::uint64_t checksum(const Grid &grid) {
+    std::uint64_t hash = 14695981039346656037ull;
+    const auto add = [&](const void *data, std::size_t size) {
+        const auto *bytes = static_cast<const std::uint8_t *>(data);
+        for (std::size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+
+    const int size[2] = {grid.width(), grid.height()};
+    add(size, sizeof(size));
+    for (int y = 0; y < grid.height(); y++) add(grid.row(y), grid.width() * sizeof(float));
+    return hash;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::uint8_t> bytes;
+    if (!read_file(options.trace, bytes)) {
+        std::fprintf(stderr, "failed to read %s\n", options.trace.c_str());
+        return 1;
+    }
+
+    TraceReader reader;
+    if (!reader.open(bytes.data(), bytes.size())) {
+        std::fprintf(stderr, "%s is not a trace of version %u\n", options.trace.c_str(), TraceWriter::version);
+        return 1;
+    }
+
+    Session session(nullptr);
+    if (options.threads) session.get_sketch().set_thread_count(options.threads);
+
+    std::printf("kernels: %s, threads: %s\n", session.get_sketch().get_kernel_isa(),
+                options.threads ? std::to_string(options.threads).c_str() : "from trace");
+    if (!options.quiet)
+        std::printf("%6s %12s %9s %9s %10s %10s %16s\n", "frame", "time ms", "delta ms", "frame ms", "resolution",
+                    "iterations", "checksum");
+
+    std::vector<double> frame_ms;
+    std::uint64_t digest = 14695981039346656037ull;
+    double time = 0.0;
+    std::size_t ticks = 0;
+
+    TraceRecord record;
+    while (reader.next(record)) {
+        switch (record.kind) {
+            case TraceRecord::tick: {
+                ticks++;
+                time += record.delta_time;
+                if (!session.tick(record.delta_time)) break;
+
+                const std::uint64_t hash = checksum(session.get_sketch().get_shown_grid());
+                digest = (digest ^ hash) * 1099511628211ull;
+                frame_ms.push_back(session.get_frame_ms());
+                if (!options.quiet)
+                    std::printf("%6zu %12.1f %9.1f %9.3f %10d %10d %016llx\n", frame_ms.size(), time,
+                                record.delta_time, session.get_frame_ms(), session.get_quality().resolution,
+                                session.get_quality().max_iterations, static_cast<unsigned long long>(hash));
+                break;
+            }
+            case TraceRecord::resize:
+                session.resize(record.values[0], record.values[1]);
+                break;
+            case TraceRecord::wheel:
+                session.zoom_at(record.values[0], record.values[1], record.values[2]);
+                break;
+            case TraceRecord::drag:
+                session.pan(record.values[0], record.values[1]);
+                break;
+            case TraceRecord::page_command:
+                if (options.threads && record.command.type == Command::threads) break;
+                session.apply_command(record.command);
+                break;
+            case TraceRecord::quality:
+                session.set_fixed_quality(record.values[0], record.values[1]);
+                break;
+        }
+    }
+
+    if (reader.is_corrupt()) std::fprintf(stderr, "the trace is cut off or corrupt, replayed up to there\n");
+
+    double total_ms = 0.0;
+    for (const double &ms : frame_ms) total_ms += ms;
+    std::vector<double> sorted = frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+    const double p95 = sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+
+    std::printf("\nticks: %zu, time: %.1f ms, frames: %zu\n", ticks, time, frame_ms.size());
+    std::printf("frame ms: total %.3f, mean %.3f, p95 %.3f, max %.3f\n", total_ms,
+                frame_ms.empty() ? 0.0 : total_ms / frame_ms.size(), p95, sorted.empty() ? 0.0 : sorted.back());
+    std::printf("digest: %016llx\n", static_cast<unsigned long long>(digest));
+    return reader.is_corrupt() ? 2 : 0;
+}
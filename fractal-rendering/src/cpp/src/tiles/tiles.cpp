@@ -0,0 +1,405 @@
+// Tile server for pan and zoom map widgets. Renders 256x256 tiles with the app's kernels and palette on a pool of
+// worker threads, each with a renderer of its own, and serves them over stdin and stdout so any front end process can
+// put it behind HTTP or a socket.
+// The square from -2 - 2i to 2 + 2i is the one tile of zoom 0, and every zoom level splits each tile in four: tile
+// (x, y) of zoom z covers the real parts from -2 + 4x / 2^z and the imaginary parts from -2 + 4y / 2^z, the imaginary
+// axis pointing down as in the app. Only julia zooms deeper than float precision (see get_min_half_height).
+//
+// Requests are lines on stdin, answered on stdout in the order they complete:
+//   ID tile FORMULA C_REAL C_IMAG ITERATIONS ZOOM X Y   ->  ID tile SIZE, then SIZE bytes of a binary PPM
+//   ID stats                                            ->  ID stats NAME VALUE...
+// or ID error MESSAGE. IDs are any word; c does not matter to the Mandelbrot-like formulas.
+// A request for a tile that is being rendered waits for that render instead of starting another. Tiles are cached in
+// memory and, with --cache-dir, in a directory that later runs pick up again (see TileCache).
+// Stats cover the time since the previous stats request: tiles served per second, the share served from either cache,
+// and the median and p99 latency from reading a request to writing its tile. They go to stderr at exit, since start.
+//
+//   fractal_tiles [--threads N] [--memory MIB] [--cache-dir PATH] [--disk MIB] [--queue N]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../BoundedQueue/BoundedQueue.hpp"
+#include "../FractalRenderer/FractalRenderer.hpp"
+#include "../Palette/Palette.hpp"
+#include "../TileCache/TileCache.hpp"
+
+namespace {
+
+constexpr int tile_size = 256;
+// tile coordinates stay exact in a double, and so does the tile center in a double-double
+constexpr int max_zoom = 52;
+constexpr int max_iterations_limit = 100000;
+
+struct Options {
+    std::size_t threads = WorkerPool::default_thread_count();
+    std::size_t memory_budget = std::size_t(256) << 20;
+    std::string cache_dir;
+    std::size_t disk_budget = std::size_t(1024) << 20;
+    std::size_t queue = 256;
+};
+
+struct Request {
+    std::string id;
+    // every parameter that changes the tile, also its file name in the cache directory
+    std::string key;
+    FractalRenderer::Formula formula = FractalRenderer::julia;
+    float c_real = 0.0f;
+    float c_imag = 0.0f;
+    int max_iterations = 0;
+    int zoom = 0;
+    std::uint64_t x = 0;
+    std::uint64_t y = 0;
+    std::chrono::steady_clock::time_point received;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr, "usage: %s [--threads N] [--memory MIB] [--cache-dir PATH] [--disk MIB] [--queue N]\n",
+                 program);
+}
+
+bool parse_options(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--threads" && has_value) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--memory" && has_value) {
+            options.memory_budget = static_cast<std::size_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        } else if (arg == "--cache-dir" && has_value) {
+            options.cache_dir = argv[++i];
+        } else if (arg == "--disk" && has_value) {
+            options.disk_budget = static_cast<std::size_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        } else if (arg == "--queue" && has_value) {
+            options.queue = std::max(1, std::atoi(argv[++i]));
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Parses the arguments of a tile request; returns false with a message when they are not a valid tile
+bool parse_tile(std::istringstream &arguments, Request &request, std::string &error) {
+    std::string formula;
+    if (!(arguments >> formula >> request.c_real >> request.c_imag >> request.max_iterations >> request.zoom >>
+          request.x >> request.y)) {
+        error = "expected FORMULA C_REAL C_IMAG ITERATIONS ZOOM X Y";
+        return false;
+    }
+    if (!FractalRenderer::find_formula(formula, request.formula)) {
+        error = "unknown formula " + formula;
+        return false;
+    }
+    if (!std::isfinite(request.c_real) || !std::isfinite(request.c_imag)) {
+        error = "c is not finite";
+        return false;
+    }
+    if (request.max_iterations < 2 || request.max_iterations > max_iterations_limit) {
+        error = "iterations out of range";
+        return false;
+    }
+    if (request.zoom < 0 || request.zoom > max_zoom || request.x >> request.zoom || request.y >> request.zoom) {
+        error = "tile out of range";
+        return false;
+    }
+
+    // c only changes the Julia sets, so the other formulas share their tiles whatever c is asked for
+    if (request.formula != FractalRenderer::julia && request.formula != FractalRenderer::julia_cubic)
+        request.c_real = request.c_imag = 0.0f;
+
+    char key[160];
+    std::snprintf(key, sizeof(key), "%s_%.9g_%.9g_%d_%d_%llu_%llu", FractalRenderer::formula_name(request.formula),
+                  request.c_real, request.c_imag, request.max_iterations, request.zoom,
+                  static_cast<unsigned long long>(request.x), static_cast<unsigned long long>(request.y));
+    request.key = key;
+    return true;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+class TileServer {
+   public:
+    explicit TileServer(const Options &options);
+    ~TileServer() { finish(); }
+
+    // Waits while the queue is full
+    void submit(Request request) { requests_.push(std::move(request)); }
+    // Serves the requests still queued and stops the workers
+    void finish();
+
+    void respond_error(const std::string &id, const std::string &message);
+    void respond_stats(const std::string &id);
+    void print_total_stats(std::FILE *file);
+    // the workers' renderers keep the widest kernel set this CPU supports
+    const char *get_kernel_isa() const noexcept { return kernels::default_kernel_set().isa; }
+
+   private:
+    enum Source { memory_hit, disk_hit, rendered, coalesced };
+
+    // Latencies are percentiles of the last max_latencies tiles, so a long running server keeps a bounded sample
+    struct Stats {
+        static constexpr std::size_t max_latencies = 1 << 20;
+
+        std::chrono::steady_clock::time_point since = std::chrono::steady_clock::now();
+        std::size_t served[4] = {};
+        std::size_t errors = 0;
+        std::vector<double> latencies;
+        std::size_t next_latency = 0;
+
+        void add(const Source &source, const double &latency) {
+            served[source]++;
+            if (latencies.size() < max_latencies)
+                latencies.push_back(latency);
+            else
+                latencies[next_latency] = latency;
+            next_latency = (next_latency + 1) % max_latencies;
+        }
+    };
+
+    TileCache cache_;
+    BoundedQueue<Request> requests_;
+    std::vector<std::thread> workers_;
+    const Palette palette_;
+
+    // requests waiting for a tile being rendered, by key
+    std::mutex in_flight_mutex_;
+    std::unordered_map<std::string, std::vector<Request>> in_flight_;
+
+    std::mutex output_mutex_;
+
+    // since the last stats request, and since start
+    std::mutex stats_mutex_;
+    Stats window_;
+    Stats total_;
+
+    void worker_loop_();
+    void serve_(Request request, FractalRenderer &fractal, std::vector<std::uint32_t> &pixels);
+    std::shared_ptr<const TileCache::Tile> render_(const Request &request, FractalRenderer &fractal,
+                                                   std::vector<std::uint32_t> &pixels, std::string &error) const;
+    void respond_tile_(const Request &request, const TileCache::Tile &tile, const Source &source);
+    void write_stats_(std::FILE *file, const char *prefix, const Stats &stats);
+};
+
+TileServer::TileServer(const Options &options)
+    : cache_(options.memory_budget, options.cache_dir, options.disk_budget), requests_(options.queue) {
+    for (std::size_t worker = 0; worker < options.threads; worker++) workers_.emplace_back([this] { worker_loop_(); });
+}
+
+void TileServer::finish() {
+    requests_.close();
+    for (std::thread &worker : workers_) worker.join();
+    workers_.clear();
+}
+
+// Each worker renders whole tiles on a single threaded renderer; requests outnumber the workers under load, so
+// splitting a tile across threads would only add synchronization
+void TileServer::worker_loop_() {
+    FractalRenderer fractal;
+    fractal.set_thread_count(1);
+    fractal.set_mirroring(false);
+    fractal.set_resolution(tile_size);
+    std::vector<std::uint32_t> pixels(tile_size * tile_size);
+
+    while (std::optional<Request> request = requests_.pop()) serve_(std::move(*request), fractal, pixels);
+}
+
+void TileServer::serve_(Request request, FractalRenderer &fractal, std::vector<std::uint32_t> &pixels) {
+    std::shared_ptr<const TileCache::Tile> tile;
+    TileCache::Source cached = cache_.load(request.key, tile);
+    if (cached != TileCache::missing) {
+        respond_tile_(request, *tile, cached == TileCache::memory ? memory_hit : disk_hit);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        const auto found = in_flight_.find(request.key);
+        if (found != in_flight_.end()) {
+            found->second.push_back(std::move(request));
+            return;
+        }
+        in_flight_[request.key];
+    }
+
+    // a render that finished between the lookup and the registration above stored its tile before it unregistered
+    std::string error;
+    cached = cache_.load(request.key, tile);
+    Source source = cached == TileCache::memory ? memory_hit : disk_hit;
+    if (cached == TileCache::missing) {
+        source = rendered;
+        tile = render_(request, fractal, pixels, error);
+        if (tile) cache_.store(request.key, tile);
+    }
+
+    std::vector<Request> waiting;
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        const auto found = in_flight_.find(request.key);
+        waiting = std::move(found->second);
+        in_flight_.erase(found);
+    }
+
+    if (!tile) {
+        respond_error(request.id, error);
+        for (const Request &other : waiting) respond_error(other.id, error);
+        return;
+    }
+    respond_tile_(request, *tile, source);
+    for (const Request &other : waiting) respond_tile_(other, *tile, coalesced);
+}
+
+// Cells sit at the centers of the tile's pixels, so neighboring tiles line up without sharing a row or column
+std::shared_ptr<const TileCache::Tile> TileServer::render_(const Request &request, FractalRenderer &fractal,
+                                                           std::vector<std::uint32_t> &pixels,
+                                                           std::string &error) const {
+    const double span = std::ldexp(4.0, -request.zoom);
+    FractalRenderer::View view;
+    view.center_x = DoubleDouble(-2.0) + DoubleDouble((static_cast<double>(request.x) + 0.5) * span);
+    view.center_y = DoubleDouble(-2.0) + DoubleDouble((static_cast<double>(request.y) + 0.5) * span);
+    view.half_height = span / 2.0 * (tile_size - 1) / tile_size;
+
+    fractal.set_formula(request.formula);
+    if (view.half_height < fractal.get_min_half_height()) {
+        error = std::string("zoom too deep for ") + FractalRenderer::formula_name(request.formula);
+        return nullptr;
+    }
+    fractal.set_view(view);
+    fractal.set_c(request.c_real, request.c_imag);
+    fractal.set_max_iterations(request.max_iterations);
+    fractal.render();
+    palette_.map_grid(fractal.grid(), fractal.is_mirrored(), pixels.data(), tile_size);
+
+    char header[32];
+    const int header_size = std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", tile_size, tile_size);
+    std::vector<std::uint8_t> bytes(header, header + header_size);
+    bytes.resize(header_size + pixels.size() * 3);
+    std::uint8_t *rgb = bytes.data() + header_size;
+    for (const std::uint32_t pixel : pixels) {
+        *rgb++ = static_cast<std::uint8_t>(pixel >> 16);
+        *rgb++ = static_cast<std::uint8_t>(pixel >> 8);
+        *rgb++ = static_cast<std::uint8_t>(pixel);
+    }
+    return std::make_shared<const TileCache::Tile>(std::move(bytes));
+}
+
+void TileServer::respond_tile_(const Request &request, const TileCache::Tile &tile, const Source &source) {
+    {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        std::fprintf(stdout, "%s tile %zu\n", request.id.c_str(), tile.size());
+        std::fwrite(tile.data(), 1, tile.size(), stdout);
+        std::fflush(stdout);
+    }
+
+    const double latency = elapsed_ms(request.received);
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    window_.add(source, latency);
+    total_.add(source, latency);
+}
+
+void TileServer::respond_error(const std::string &id, const std::string &message) {
+    {
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        std::fprintf(stdout, "%s error %s\n", id.c_str(), message.c_str());
+        std::fflush(stdout);
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    window_.errors++;
+    total_.errors++;
+}
+
+void TileServer::respond_stats(const std::string &id) {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats = std::move(window_);
+        window_ = Stats();
+    }
+
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    write_stats_(stdout, (id + " stats").c_str(), stats);
+    std::fflush(stdout);
+}
+
+void TileServer::print_total_stats(std::FILE *file) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    write_stats_(file, "stats", total_);
+}
+
+void TileServer::write_stats_(std::FILE *file, const char *prefix, const Stats &stats) {
+    std::size_t served = 0;
+    for (const std::size_t &count : stats.served) served += count;
+    const std::size_t hits = stats.served[memory_hit] + stats.served[disk_hit];
+
+    std::vector<double> latencies = stats.latencies;
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](std::size_t percent) {
+        return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, latencies.size() * percent / 100)];
+    };
+
+    std::fprintf(file,
+                 "%s tiles_per_s %.1f hit_rate %.3f memory_hits %zu disk_hits %zu rendered %zu coalesced %zu "
+                 "errors %zu p50_ms %.3f p99_ms %.3f memory_bytes %zu disk_bytes %zu\n",
+                 prefix, served * 1000.0 / std::max(elapsed_ms(stats.since), 1.0),
+                 served ? static_cast<double>(hits) / served : 0.0, stats.served[memory_hit], stats.served[disk_hit],
+                 stats.served[rendered], stats.served[coalesced], stats.errors, percentile(50), percentile(99),
+                 cache_.get_memory_size(), cache_.get_disk_size());
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    TileServer server(options);
+    std::fprintf(stderr, "serving %dx%d tiles on %zu threads (kernels: %s)\n", tile_size, tile_size, options.threads,
+                 server.get_kernel_isa());
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream arguments(line);
+        Request request;
+        std::string type;
+        if (!(arguments >> request.id)) continue;
+        request.received = std::chrono::steady_clock::now();
+
+        std::string error;
+        if (!(arguments >> type)) {
+            server.respond_error(request.id, "expected a request type");
+        } else if (type == "stats") {
+            server.respond_stats(request.id);
+        } else if (type != "tile") {
+            server.respond_error(request.id, "unknown request type " + type);
+        } else if (!parse_tile(arguments, request, error)) {
+            server.respond_error(request.id, error);
+        } else {
+            server.submit(std::move(request));
+        }
+    }
+
+    server.finish();
+    server.print_total_stats(stderr);
+    return 0;
+}
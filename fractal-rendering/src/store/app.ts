@@ -1,13 +1,46 @@
 // Utilities
 import { defineStore } from 'pinia';
 
+export interface ProfileSummary {
+  min: number;
+  mean: number;
+  p95: number;
+}
+
+// Stage durations are in milliseconds, counters are per frame
+export interface Profile {
+  frames: number;
+  stages: Record<string, ProfileSummary>;
+  counters: Record<string, ProfileSummary>;
+}
+
 export const useAppStore = defineStore('app', {
   state: () => ({
     frameRate: 0 as number,
+    // render loop wakeups per second and the share of the time it was busy, which drop while nothing changes
+    wakeupRate: 0 as number,
+    cpuLoad: 0 as number,
+    progress: 0 as number,
+    // share of frames replayed from the frame cache and its size in bytes, 0 when it is off
+    cacheHitRate: 0 as number,
+    cacheBytes: 0 as number,
+    profile: null as Profile | null,
   }),
   actions: {
     setFrameRate(frameRate: number) {
       this.frameRate = frameRate;
     },
+    setActivity(wakeupRate: number, cpuLoad: number, progress: number) {
+      this.wakeupRate = wakeupRate;
+      this.cpuLoad = cpuLoad;
+      this.progress = progress;
+    },
+    setFrameCache(hitRate: number, bytes: number) {
+      this.cacheHitRate = hitRate;
+      this.cacheBytes = bytes;
+    },
+    setProfile(profile: Profile) {
+      this.profile = profile;
+    },
   },
 });
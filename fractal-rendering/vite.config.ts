@@ -46,6 +46,17 @@ export default defineConfig({
   },
   server: {
     port: 3000,
+    // SharedArrayBuffer for the wasm worker threads (builds with -DFLOW_THREADS=ON) needs a cross-origin isolated page
+    headers: {
+      'Cross-Origin-Opener-Policy': 'same-origin',
+      'Cross-Origin-Embedder-Policy': 'require-corp',
+    },
+  },
+  preview: {
+    headers: {
+      'Cross-Origin-Opener-Policy': 'same-origin',
+      'Cross-Origin-Embedder-Policy': 'require-corp',
+    },
   },
   base: '/fractal-rendering/'
 });